@@ -0,0 +1,158 @@
+"""Board identity (`ID?` -> `Target: ID ...`) and the per-board result history.
+
+Firmware with the `id` feature answers `ID?` with the chip's factory data:
+
+    Target: ID devid=1A2B3C4D5E6F7081 addr=D1C2B3A4F5E6 addrtype=rnd part=52840 variant=AAD0 flash_kb=1024 ram_kb=256 bl=F4000
+
+devid (FICR DEVICEID) is unique per nRF52 chip and survives reflashing, so
+the app keys every finished run by it in a SQLite database next to the
+executable (traces/board_history.sqlite). Before a run starts the app looks
+the board up, logs its earlier outcomes and, when configured, skips boards
+that already passed within a time window (boards mixed up in trays).
+
+Usage:
+    python board_history.py traces/board_history.sqlite              # boards, newest first
+    python board_history.py traces/board_history.sqlite 1A2B3C4D5E6F7081
+"""
+import argparse
+import sqlite3
+import sys
+import time
+from dataclasses import dataclass, field
+
+
+@dataclass
+class BoardIdentity:
+    devid: str
+    addr: str = ""
+    part: str = ""
+    variant: str = ""
+    flash_kb: int = 0
+    ram_kb: int = 0
+    bootloader: str = ""  # bootloader start address (hex) or "none"
+    extra: dict = field(default_factory=dict)
+
+    def summary(self) -> str:
+        return (f"board {self.devid} nRF{self.part}-{self.variant} flash {self.flash_kb} KB ram {self.ram_kb} KB "
+                f"bootloader {'at 0x' + self.bootloader if self.bootloader not in ('', 'none') else 'none'}")
+
+
+def parse_identity(line: str) -> BoardIdentity | None:
+    """Parse 'Target: ID devid=.. addr=..'; None for anything else."""
+    parts = line.split()
+    if len(parts) < 3 or parts[1].upper() != "ID":
+        return None
+    kv = {}
+    for token in parts[2:]:
+        key, sep, value = token.partition("=")
+        if sep:
+            kv[key.lower()] = value
+    devid = kv.pop("devid", "").upper()
+    if not devid:
+        return None
+    ident = BoardIdentity(devid, addr=kv.pop("addr", "").upper(), part=kv.pop("part", ""),
+                          variant=kv.pop("variant", ""), bootloader=kv.pop("bl", ""))
+    try:
+        ident.flash_kb = int(kv.pop("flash_kb", "0"))
+        ident.ram_kb = int(kv.pop("ram_kb", "0"))
+    except ValueError:
+        return None
+    ident.extra = kv
+    return ident
+
+
+@dataclass
+class RunRecord:
+    ts: float
+    verdict: str   # "pass" / "fail"
+    mode: str
+    defects: str   # RESULT defect fields, e.g. "SEQ=P0_31 XTALK=P0_29"
+    station: str
+
+
+class BoardHistory:
+    """Per-board results in one SQLite file (GUI thread only)."""
+
+    def __init__(self, path: str):
+        self.path = path
+        self.db = sqlite3.connect(path)
+        self.db.executescript("""
+            CREATE TABLE IF NOT EXISTS boards (
+                devid TEXT PRIMARY KEY, addr TEXT, part TEXT, variant TEXT,
+                flash_kb INTEGER, ram_kb INTEGER, bootloader TEXT,
+                first_seen REAL, last_seen REAL);
+            CREATE TABLE IF NOT EXISTS runs (
+                id INTEGER PRIMARY KEY, devid TEXT NOT NULL, ts REAL NOT NULL,
+                verdict TEXT, mode TEXT, defects TEXT, duration_s REAL, station TEXT);
+            CREATE INDEX IF NOT EXISTS runs_devid_ts ON runs (devid, ts);
+        """)
+
+    def close(self):
+        self.db.close()
+
+    def seen(self, ident: BoardIdentity):
+        now = time.time()
+        with self.db:
+            self.db.execute(
+                "INSERT INTO boards VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?) "
+                "ON CONFLICT(devid) DO UPDATE SET addr=excluded.addr, part=excluded.part, variant=excluded.variant, "
+                "flash_kb=excluded.flash_kb, ram_kb=excluded.ram_kb, bootloader=excluded.bootloader, "
+                "last_seen=excluded.last_seen",
+                (ident.devid, ident.addr, ident.part, ident.variant, ident.flash_kb, ident.ram_kb,
+                 ident.bootloader, now, now))
+
+    def record_run(self, devid: str, verdict: str, mode: str, defects: str, duration_s: float | None,
+                   station: str):
+        with self.db:
+            self.db.execute("INSERT INTO runs (devid, ts, verdict, mode, defects, duration_s, station) "
+                            "VALUES (?, ?, ?, ?, ?, ?, ?)",
+                            (devid, time.time(), verdict, mode, defects, duration_s, station))
+
+    def runs(self, devid: str, limit: int = 5) -> list[RunRecord]:
+        """Newest first."""
+        rows = self.db.execute("SELECT ts, verdict, mode, defects, station FROM runs WHERE devid = ? "
+                               "ORDER BY ts DESC LIMIT ?", (devid, limit)).fetchall()
+        return [RunRecord(*row) for row in rows]
+
+    def passed_since(self, devid: str, since_ts: float) -> RunRecord | None:
+        """The latest pass newer than since_ts, if the board has not failed after it."""
+        rows = self.runs(devid, 1)
+        if rows and rows[0].verdict == "pass" and rows[0].ts >= since_ts:
+            return rows[0]
+        return None
+
+
+def describe_runs(runs: list[RunRecord], now: float | None = None) -> str:
+    """'3 earlier runs: PASS 5 min ago (FULL), FAIL 12 min ago (FULL, SEQ=P0_31), ...'"""
+    now = time.time() if now is None else now
+    parts = []
+    for r in runs:
+        age = now - r.ts
+        ago = f"{age / 60:.0f} min" if age < 3600 else f"{age / 3600:.1f} h" if age < 172800 else f"{age / 86400:.0f} days"
+        detail = r.mode + (f", {r.defects}" if r.defects else "")
+        parts.append(f"{r.verdict.upper()} {ago} ago ({detail})")
+    return f"{len(runs)} earlier run{'s' if len(runs) != 1 else ''}: " + ", ".join(parts)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="List boards and their runs from the result history")
+    parser.add_argument("db", help="board_history.sqlite")
+    parser.add_argument("devid", nargs="?", help="show the runs of one board")
+    args = parser.parse_args(argv)
+    history = BoardHistory(args.db)
+    fmt = lambda ts: time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(ts))
+    if args.devid:
+        for r in history.runs(args.devid.upper(), limit=1000):
+            print(f"{fmt(r.ts)}  {r.verdict:<4} {r.mode:<4} {r.station:<12} {r.defects}")
+        return 0
+    rows = history.db.execute(
+        "SELECT b.devid, b.part, b.variant, b.last_seen, COUNT(r.id), "
+        "(SELECT verdict FROM runs WHERE devid = b.devid ORDER BY ts DESC LIMIT 1) "
+        "FROM boards b LEFT JOIN runs r ON r.devid = b.devid GROUP BY b.devid ORDER BY b.last_seen DESC").fetchall()
+    for devid, part, variant, last_seen, count, last in rows:
+        print(f"{devid}  nRF{part}-{variant}  last seen {fmt(last_seen)}  runs {count:3d}  last {last or '-'}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
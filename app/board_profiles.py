@@ -0,0 +1,75 @@
+"""Board profiles known to the app (mirror of mcu_firmwares/include/board_profile.h).
+
+Both firmwares report their compile-time profile in the HELLO? descriptor
+(`profile=<name>`). The app uses it to choose the pinout drawing and the pin
+labels to check the descriptor's pin-map hash against.
+"""
+import re
+from dataclasses import dataclass
+
+# Pinout rows (left, right) top to bottom; GND and B+ are not tested, and an
+# empty text leaves that side without a circle.
+SUPERMINI_ROWS = [
+    ("GND", "B+"),
+    ("D1  P0.06", "B+"),
+    ("D0  P0.08", "GND"),
+    ("GND", "RESET"),
+    ("GND", "P0.13 VCC"),  # VCC pad: the Target's VccCtrl, test line 0
+    ("D2  P0.17", "P0.31 D21"),
+    ("D3  P0.20", "P0.29 D20"),
+    ("D4  P0.22", "P0.02 D19"),
+    ("D5  P0.24", "P1.15 D18"),
+    ("D6  P1.00", "P1.13 D15"),
+    ("D7  P0.11", "P1.11 D14"),
+    ("D8  P1.04", "P0.10 D16"),
+    ("D9  P1.06", "P0.09 D10"),
+]
+
+SUPERMINI_LABELS = [
+    "P0_13(VCC)", "P0_31", "P0_29", "P0_02", "P1_15", "P1_13", "P1_11", "P0_10", "P0_09",
+    "P1_06", "P1_04", "P0_11", "P1_00", "P0_24", "P0_22", "P0_20", "P0_17", "P0_08", "P0_06",
+]
+
+
+@dataclass(frozen=True)
+class BoardProfile:
+    name: str
+    labels: tuple[str, ...]
+    pin_rows: tuple[tuple[str, str], ...]
+
+
+PROFILES = {
+    p.name: p for p in (
+        BoardProfile("supermini", tuple(SUPERMINI_LABELS), tuple(SUPERMINI_ROWS)),
+        BoardProfile(
+            "supermini_ext",
+            tuple(SUPERMINI_LABELS + ["P1_01", "P1_02", "P1_07"]),
+            tuple(SUPERMINI_ROWS + [("P1.01 pad", "pad P1.02"), ("P1.07 pad", "")]),
+        ),
+    )
+}
+
+DEFAULT_PROFILE = PROFILES["supermini"]
+
+
+def pin_id(text: str) -> str | None:
+    """Canonical pin ID of a label or pad text: 'P0_13(VCC)' and 'D1  P0.06' -> 'P0_13', 'P0_06'."""
+    m = re.search(r"P([01])[._](\d{2})", text)
+    return f"P{m.group(1)}_{m.group(2)}" if m else None
+
+
+def with_neighbours(profile: BoardProfile, pins: set[str]) -> set[str]:
+    """The pins plus the pads right above and below them on the same header side
+    (the pads a solder bridge or a bent pogo pin reaches)."""
+    columns = [[pin_id(row[side]) for row in profile.pin_rows] for side in (0, 1)]
+    out = set(pins)
+    for column in columns:
+        for i, pin in enumerate(column):
+            if pin in pins:
+                out.update(p for p in column[max(0, i - 1):i + 2] if p)
+    return out
+
+
+def pin_mask(profile: BoardProfile, pins: set[str]) -> int:
+    """Bitmap over the profile's test order (TestPins index) of the given pin IDs."""
+    return sum(1 << i for i, label in enumerate(profile.labels) if pin_id(label) in pins)
@@ -1,31 +1,42 @@
 import time
 from PySide6.QtWidgets import QComboBox
 
-try:
-    from serial.tools import list_ports as serial_list_ports
-except Exception:
-    serial_list_ports = None
+# Placeholder shown until the background port scan reports
+SCANNING_ITEM = "<scanning ports...>"
+
+
+# USB VID/PID of the tester firmwares (boards/nicenano.json). The bootloader's
+# DFU IDs (0x0029, 0x002A) are left out: a board in DFU cannot run a test.
+TESTER_USB_IDS = {(0x239A, 0x8029), (0x239A, 0x802A)}
+
+
+def is_tester_port(info) -> bool:
+    """True when a pyserial ListPortInfo is a Master or Target running its firmware."""
+    return (getattr(info, "vid", None), getattr(info, "pid", None)) in TESTER_USB_IDS
+
+
+def port_items(ports_info) -> list[str]:
+    """Combo items like 'COM5 (desc)' for pyserial ListPortInfo objects."""
+    items = [
+        f"{p.device} ({p.description})" if getattr(p, "description", None) else p.device
+        for p in ports_info
+    ]
+    return items or ["<no ports detected>"]
 
 
 def get_ports_list():
     """Return a list of combo items like 'COM5 (desc)' for detected ports.
     Falls back to placeholders when pyserial is missing or no ports are found.
+    pyserial is imported on first use, not at startup.
     """
-    ports = []
     try:
-        if serial_list_ports:
-            ports_info = serial_list_ports.comports()
-            ports = [
-                f"{p.device} ({p.description})" if getattr(p, "description", None) else p.device
-                for p in ports_info
-            ]
-        else:
-            ports = ["<pyserial not installed>"]
+        from serial.tools import list_ports as serial_list_ports
+    except Exception:
+        return ["<pyserial not installed>"]
+    try:
+        return port_items(serial_list_ports.comports())
     except Exception:
-        ports = []
-    if not ports:
-        ports = ["<no ports detected>"]
-    return ports
+        return ["<no ports detected>"]
 
 
 
@@ -0,0 +1,129 @@
+"""Board capability descriptor (`HELLO?` -> `DESC ...`).
+
+On connect the app sends `HELLO?` to each board; firmware that knows the
+command answers with one line:
+
+    Master: DESC proto=2 build=1760000000 profile=supermini pins=19 pinhash=892CFC42 features=0xbf ...
+    Target: DESC proto=2 build=1760000000 profile=supermini pins=19 pinhash=892CFC42 features=0xcf seq_ms=150
+
+Older firmware ignores the command, so "no descriptor" means protocol 1 and
+the legacy pacing. The pin-map hash (FNV-1a over the comma-joined pin labels)
+lets the app detect boards flashed from a different pin map before a run.
+"""
+from dataclasses import dataclass, field
+
+try:
+    from .board_profiles import DEFAULT_PROFILE, PROFILES
+except Exception:
+    try:
+        from app.board_profiles import DEFAULT_PROFILE, PROFILES
+    except Exception:
+        from board_profiles import DEFAULT_PROFILE, PROFILES
+
+# Feature bits (must match the FEAT_* constants in both firmwares)
+FEAT_STAGES = 1 << 0      # ALL_HIGH / ALL_LOW / SEQUENCE
+FEAT_TRACE = 1 << 1       # TRACE ON/OFF, TIMESYNC
+FEAT_MEM = 1 << 2         # MEM
+FEAT_LINK_PROBE = 1 << 3  # PING, BLAST
+FEAT_MODES = 1 << 4       # START FAST|FULL, RESULT line
+FEAT_AUTOSTART = 1 << 5   # AUTOSTART, TARGET_SEATED
+FEAT_PIN_ACK = 1 << 6     # Target prints PIN_UP once a SEQUENCE pin is raised
+FEAT_STANDALONE = 1 << 7  # PC-less runs; Master keeps the JOURNAL? result journal
+FEAT_XTALK = 1 << 8       # XTALK crosstalk stage (Target aggressor, Master glitch counts)
+FEAT_CLOCK = 1 << 9       # CLOCK HF/LF crystal accuracy stage (ppm against the Master)
+FEAT_ID = 1 << 10         # Target answers ID? with its FICR chip ID (board_history.py)
+FEAT_PIN_MASK = 1 << 11   # START RETEST <mask> (Master), START_SEQUENCE <mask> (Target)
+FEAT_MONITOR = 1 << 12    # MONITOR ON/OFF live pin-state stream (Master), HOLD <mask> (Target)
+FEAT_VCC = 1 << 13        # VCC switch stage: on/off transition times and dropouts (vcc_test.h)
+FEAT_RECOVERY = 1 << 14   # Master: INIT aborts a host-paced run, RESET_TARGET (session_watchdog.py)
+
+FEATURE_NAMES = {
+    FEAT_STAGES: "stages",
+    FEAT_TRACE: "trace",
+    FEAT_MEM: "mem",
+    FEAT_LINK_PROBE: "link_probe",
+    FEAT_MODES: "modes",
+    FEAT_AUTOSTART: "autostart",
+    FEAT_PIN_ACK: "pin_ack",
+    FEAT_STANDALONE: "standalone",
+    FEAT_XTALK: "xtalk",
+    FEAT_CLOCK: "clock",
+    FEAT_ID: "id",
+    FEAT_PIN_MASK: "pin_mask",
+    FEAT_MONITOR: "monitor",
+    FEAT_VCC: "vcc",
+    FEAT_RECOVERY: "recovery",
+}
+
+# Pin labels in harness order of the default profile (firmware board_profile.h)
+EXPECTED_PIN_LABELS = list(DEFAULT_PROFILE.labels)
+
+
+def pin_map_hash(labels) -> int:
+    """FNV-1a (32-bit) over the labels joined by ','."""
+    h = 0x811C9DC5
+    for b in ",".join(labels).encode("ascii"):
+        h ^= b
+        h = (h * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+EXPECTED_PIN_HASH = pin_map_hash(EXPECTED_PIN_LABELS)
+
+
+def expected_pin_hash(profile: str) -> int | None:
+    """Pin-map hash of a known profile; None when the app does not know it."""
+    p = PROFILES.get(profile or DEFAULT_PROFILE.name)
+    return pin_map_hash(p.labels) if p else None
+
+
+@dataclass
+class Descriptor:
+    role: str
+    proto: int = 1
+    build: str = ""
+    profile: str = ""  # empty for firmware that predates board profiles
+    pins: int = 0
+    pinhash: int = 0
+    features: int = 0
+    timings: dict = field(default_factory=dict)  # remaining key=value pairs (ints)
+
+    def has(self, feature: int) -> bool:
+        return bool(self.features & feature)
+
+    def feature_names(self) -> list[str]:
+        return [name for bit, name in FEATURE_NAMES.items() if self.features & bit]
+
+    def summary(self) -> str:
+        return (f"proto {self.proto}, build {self.build}, profile {self.profile or '?'}, {self.pins} pins, "
+                f"features: {', '.join(self.feature_names()) or 'none'}")
+
+
+def parse_desc(line: str) -> Descriptor | None:
+    """Parse a '<Role>: DESC k=v ...' line, or return None."""
+    head, sep, rest = line.partition(": DESC")
+    if not sep:
+        return None
+    d = Descriptor(role=head.strip().lower())
+    for token in rest.split():
+        key, eq, value = token.partition("=")
+        if not eq:
+            continue
+        try:
+            if key == "proto":
+                d.proto = int(value)
+            elif key == "build":
+                d.build = value
+            elif key == "profile":
+                d.profile = value
+            elif key == "pins":
+                d.pins = int(value)
+            elif key == "pinhash":
+                d.pinhash = int(value, 16)
+            elif key == "features":
+                d.features = int(value, 0)
+            else:
+                d.timings[key] = int(value)
+        except ValueError:
+            continue
+    return d
@@ -0,0 +1,150 @@
+"""Golden-board signature of a fixture, and tolerance-band comparison.
+
+Absolute limits do not fit every fixture: cable length, pogo pin wear and
+the load on the VCC rail shift the timing of a good board from station to
+station. Instead, a known-good board is run a few times in learn mode, and
+the station keeps its signature, one reference value per key:
+
+    <pin>/latency_s  host time from AWAIT_PIN to the Master's SEQUENCE OK line
+    <pin>/settle_us  Master time from NEXT_PIN to the pin read HIGH
+    VCC/off_us       VCC switch-off transition (VCC stage, when enabled)
+    VCC/on_us        VCC switch-on transition
+
+Each key gets a band ref ± max(floor, rel * |ref|, K_SIGMA * sd of the
+learned runs). A later run is flattened to the same keys and checked in one
+pass over parallel tuples; keys the run did not measure (masked pins,
+skipped stages) are not compared. The signature only applies to the board
+profile and pacing it was learned with, because the latencies depend on
+both.
+
+The signature is a small JSON file per station in the traces directory:
+
+    python golden.py traces/golden_<station>.json           # print the bands
+    python golden.py traces/golden_<station>.json --clear   # forget it
+"""
+import argparse
+import json
+import math
+import os
+import sys
+
+LEARN_RUNS = 3  # passing runs of the golden board averaged into the signature
+K_SIGMA = 4.0   # band width in standard deviations of the learned runs
+
+# stat -> (absolute floor, relative tolerance) of the band half-width
+TOLERANCES = {
+    "latency_s": (0.05, 0.5),    # GUI timer and USB jitter
+    "settle_us": (1000.0, 0.5),  # Master polls the pin every millisecond
+    "off_us": (500.0, 0.3),      # rail discharge through the fixture's load
+    "on_us": (100.0, 0.3),       # switch and soft start
+}
+
+
+def flatten(pin_samples: dict[str, dict[str, float]], vcc: dict[str, float] | None = None) -> dict[str, float]:
+    """One run's measurements as {"<pin>/<stat>": value}, restricted to the stats with a tolerance."""
+    values = {f"{pin}/{stat}": float(x) for pin, stats in pin_samples.items()
+              for stat, x in stats.items() if stat in TOLERANCES}
+    for stat, x in (vcc or {}).items():
+        if stat in TOLERANCES:
+            values[f"VCC/{stat}"] = float(x)
+    return values
+
+
+def band(stat: str, ref: float, sd: float) -> float:
+    floor, rel = TOLERANCES[stat]
+    return max(floor, rel * abs(ref), K_SIGMA * sd)
+
+
+class GoldenSignature:
+    """Reference values and bands of one station, persisted to `path`."""
+
+    def __init__(self, path: str):
+        self.path = path
+        self.context: dict = {}  # profile and pacing the signature was learned with
+        self.runs = 0
+        self.values: dict[str, tuple[float, float]] = {}  # key -> (mean, sd)
+        try:
+            with open(path, "r", encoding="utf-8") as f:
+                data = json.load(f)
+            self.context = dict(data.get("context", {}))
+            self.runs = int(data.get("runs", 0))
+            self.values = {key: (float(v[0]), float(v[1])) for key, v in data.get("values", {}).items()}
+        except (OSError, ValueError, TypeError, IndexError):
+            pass
+        self._index()
+
+    @property
+    def learned(self) -> bool:
+        return bool(self.values)
+
+    def learn(self, runs: list[dict[str, float]], context: dict):
+        """Set the signature from flattened runs of the golden board; keys missing from a run are dropped."""
+        keys = set.intersection(*(set(run) for run in runs)) if runs else set()
+        self.values = {}
+        for key in sorted(keys):
+            xs = [run[key] for run in runs]
+            mean = sum(xs) / len(xs)
+            sd = math.sqrt(sum((x - mean) ** 2 for x in xs) / (len(xs) - 1)) if len(xs) > 1 else 0.0
+            self.values[key] = (mean, sd)
+        self.context = dict(context)
+        self.runs = len(runs)
+        self._index()
+
+    def clear(self):
+        self.values = {}
+        self.context = {}
+        self.runs = 0
+        self._index()
+
+    def compare(self, run: dict[str, float]) -> list[tuple[str, float, float, float]]:
+        """(key, value, ref, band) of every measured key outside its band."""
+        get = run.get
+        return [(key, x, ref, tol) for key, ref, tol, x in zip(self._keys, self._ref, self._tol, map(get, self._keys))
+                if x is not None and abs(x - ref) > tol]
+
+    def save(self):
+        data = {"k_sigma": K_SIGMA, "context": self.context, "runs": self.runs,
+                "values": {key: list(v) for key, v in self.values.items()}}
+        os.makedirs(os.path.dirname(self.path) or ".", exist_ok=True)
+        tmp = self.path + ".tmp"
+        with open(tmp, "w", encoding="utf-8") as f:
+            json.dump(data, f)
+        os.replace(tmp, self.path)
+
+    def _index(self):
+        """Parallel key/reference/band tuples, built once per signature for compare()."""
+        keys = sorted(self.values)
+        self._keys = tuple(keys)
+        self._ref = tuple(self.values[key][0] for key in keys)
+        self._tol = tuple(band(key.rpartition("/")[2], *self.values[key]) for key in keys)
+
+
+def describe(deviation: tuple[str, float, float, float]) -> str:
+    key, x, ref, tol = deviation
+    return f"{key} {x:.4g} outside {ref:.4g} ± {tol:.4g}"
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Print or clear the golden-board signature of a station")
+    parser.add_argument("state", help="golden_<station>.json")
+    parser.add_argument("--clear", action="store_true", help="forget the signature")
+    args = parser.parse_args(argv)
+    signature = GoldenSignature(args.state)
+    if args.clear:
+        signature.clear()
+        signature.save()
+        print("cleared")
+        return 0
+    if not signature.learned:
+        print("no signature learned")
+        return 0
+    context = " ".join(f"{k}={v}" for k, v in sorted(signature.context.items()))
+    print(f"learned from {signature.runs} runs ({context})")
+    print(f"{'key':<22} {'golden':>10} {'sd':>10} {'band ±':>10}")
+    for key, ref, tol in zip(signature._keys, signature._ref, signature._tol):
+        print(f"{key:<22} {ref:10.4g} {signature.values[key][1]:10.4g} {tol:10.4g}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
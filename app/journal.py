@@ -0,0 +1,248 @@
+"""Download and decode the Master's on-flash result journal.
+
+The Master journals every run (standalone or host-driven) on its internal
+flash. `JOURNAL?` streams the whole journal in one transfer:
+
+    Master: JOURNAL BEGIN records=<n> recsize=24 pinhash=<hex> runs=<n> passes=<n>
+    Master: JREC <hex>          up to 6 packed records per line, oldest first
+    Master: JPIN <label> high=<n> low=<n> seq=<n>
+    Master: JOURNAL END records=<n>
+
+A record is 24 bytes, little endian (journal.h Record): run number, the
+ALL_HIGH / ALL_LOW / SEQUENCE defect bitmaps and the tested pins in
+TestPins order, duration in 10 ms units, flags (mode, standalone, crosstalk,
+clock and VCC failures) and a CRC-8. Firmware from before the tested-pin
+mask sends 20-byte records (recsize=20) without it. `JOURNAL CLEAR` empties
+the journal.
+
+Close the GUI first when using the command line: it opens the port itself.
+
+Usage:
+    python journal.py                          # auto-detect the Master
+    python journal.py COM5 --csv journal.csv --clear
+"""
+import argparse
+import csv
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+
+try:
+    from .board_profiles import DEFAULT_PROFILE, PROFILES
+    from .descriptor import pin_map_hash
+except Exception:
+    try:
+        from app.board_profiles import DEFAULT_PROFILE, PROFILES
+        from app.descriptor import pin_map_hash
+    except Exception:
+        from board_profiles import DEFAULT_PROFILE, PROFILES
+        from descriptor import pin_map_hash
+
+RECORD = struct.Struct("<IIIIIHBB")  # run, high, low, seq, tested, duration_cs, flags, crc
+RECORD_V1 = struct.Struct("<IIIIHBB")  # recsize=20: no tested mask (all pins)
+
+FLAG_PASS = 1 << 0
+FLAG_FULL = 1 << 1
+FLAG_STANDALONE = 1 << 2
+FLAG_RETEST = 1 << 3
+FLAG_XTALK_FAIL = 1 << 4
+FLAG_CLOCK_FAIL = 1 << 5
+FLAG_VCC_FAIL = 1 << 6
+ALL_PINS = 0xFFFFFFFF
+
+
+def crc8(data: bytes) -> int:
+    """CRC-8, polynomial 0x07, initial value 0 (journal.cpp crc8)."""
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def labels_for_hash(pinhash: int) -> list[str]:
+    """Pin labels of the board profile with this pin-map hash (default profile if unknown)."""
+    for profile in PROFILES.values():
+        if pin_map_hash(profile.labels) == pinhash:
+            return list(profile.labels)
+    return list(DEFAULT_PROFILE.labels)
+
+
+def mask_labels(mask: int, labels: list[str]) -> list[str]:
+    return [label for i, label in enumerate(labels) if mask & (1 << i)]
+
+
+@dataclass
+class JournalRecord:
+    run: int
+    high: int
+    low: int
+    seq: int
+    tested: int
+    duration_s: float
+    flags: int
+    crc_ok: bool
+
+    @property
+    def passed(self) -> bool:
+        return bool(self.flags & FLAG_PASS)
+
+    @property
+    def standalone(self) -> bool:
+        return bool(self.flags & FLAG_STANDALONE)
+
+    @property
+    def mode(self) -> str:
+        if self.flags & FLAG_RETEST:
+            return "RETEST"
+        return "FULL" if self.flags & FLAG_FULL else "FAST"
+
+    @property
+    def stage_failures(self) -> list[str]:
+        """Failed stages without a per-pin bitmap in the record."""
+        return [name for flag, name in ((FLAG_XTALK_FAIL, "XTALK"), (FLAG_CLOCK_FAIL, "CLOCK"), (FLAG_VCC_FAIL, "VCC"))
+                if self.flags & flag]
+
+    @classmethod
+    def unpack(cls, raw: bytes) -> "JournalRecord":
+        if len(raw) == RECORD_V1.size:
+            run, high, low, seq, cs, flags, crc = RECORD_V1.unpack(raw)
+            tested = ALL_PINS
+        else:
+            run, high, low, seq, tested, cs, flags, crc = RECORD.unpack(raw)
+        return cls(run, high, low, seq, tested, cs / 100.0, flags, crc8(raw[:-1]) == crc)
+
+
+@dataclass
+class Journal:
+    """A complete download; `pins` maps label -> (high, low, seq) defect counts."""
+    pinhash: int = 0
+    runs: int = 0
+    passes: int = 0
+    records: list[JournalRecord] = field(default_factory=list)
+    pins: dict[str, tuple[int, int, int]] = field(default_factory=dict)
+
+    @property
+    def labels(self) -> list[str]:
+        return labels_for_hash(self.pinhash)
+
+    @property
+    def bad_records(self) -> int:
+        return sum(1 for r in self.records if not r.crc_ok)
+
+    def summary(self) -> str:
+        yield_pct = 100.0 * self.passes / self.runs if self.runs else 0.0
+        worst = sorted(self.pins.items(), key=lambda kv: sum(kv[1]), reverse=True)
+        worst_txt = ", ".join(f"{label} {sum(c)}" for label, c in worst[:3] if sum(c)) or "none"
+        return (f"{len(self.records)} records, {self.runs} runs, yield {yield_pct:.1f}%, "
+                f"worst pins: {worst_txt}"
+                + (f", {self.bad_records} corrupt" if self.bad_records else ""))
+
+
+class JournalCollector:
+    """Feeds on Master lines; `feed` returns the Journal once END arrives."""
+
+    def __init__(self):
+        self._journal: Journal | None = None
+        self._recsize = RECORD.size
+
+    @property
+    def active(self) -> bool:
+        return self._journal is not None
+
+    def feed(self, line: str) -> Journal | None:
+        head, _, rest = line.partition(": ")
+        if head.strip().lower() != "master":
+            return None
+        if rest.startswith("JOURNAL BEGIN"):
+            kv = dict(t.split("=", 1) for t in rest.split()[2:] if "=" in t)
+            self._recsize = int(kv.get("recsize", RECORD.size))
+            self._journal = Journal(pinhash=int(kv.get("pinhash", "0"), 16),
+                                    runs=int(kv.get("runs", 0)), passes=int(kv.get("passes", 0)))
+            return None
+        j = self._journal
+        if j is None:
+            return None
+        if rest.startswith("JREC "):
+            raw = bytes.fromhex(rest[5:].strip())
+            for off in range(0, len(raw) - self._recsize + 1, self._recsize):
+                j.records.append(JournalRecord.unpack(raw[off:off + self._recsize]))
+        elif rest.startswith("JPIN "):
+            parts = rest.split()
+            kv = dict(t.split("=", 1) for t in parts[2:] if "=" in t)
+            j.pins[parts[1]] = (int(kv.get("high", 0)), int(kv.get("low", 0)), int(kv.get("seq", 0)))
+        elif rest.startswith("JOURNAL END"):
+            self._journal = None
+            return j
+        return None
+
+
+def write_csv(path: str, journal: Journal):
+    labels = journal.labels
+    with open(path, "w", newline="", encoding="utf-8") as f:
+        w = csv.writer(f)
+        w.writerow(["run", "verdict", "mode", "standalone", "duration_s", "high", "low", "seq", "stages", "untested",
+                    "crc_ok"])
+        for r in journal.records:
+            w.writerow([r.run, "PASS" if r.passed else "FAIL", r.mode, int(r.standalone), f"{r.duration_s:.2f}",
+                        " ".join(mask_labels(r.high, labels)), " ".join(mask_labels(r.low, labels)),
+                        " ".join(mask_labels(r.seq, labels)), " ".join(r.stage_failures),
+                        " ".join(mask_labels(~r.tested, labels)), int(r.crc_ok)])
+
+
+def download(device: str, baud: int = 115200, timeout_s: float = 10.0, clear: bool = False) -> Journal:
+    import serial  # type: ignore
+
+    collector = JournalCollector()
+    with serial.Serial(device, baudrate=baud, timeout=0.2) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"JOURNAL?\n")
+        deadline = time.monotonic() + timeout_s
+        while time.monotonic() < deadline:
+            line = ser.readline().decode("utf-8", errors="replace").strip()
+            journal = collector.feed(line) if line else None
+            if journal is not None:
+                if clear:
+                    ser.write(b"JOURNAL CLEAR\n")
+                    ser.flush()
+                return journal
+    raise TimeoutError(f"{device}: no complete JOURNAL reply within {timeout_s:.0f} s")
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Download the Master's on-flash result journal")
+    parser.add_argument("port", nargs="?", help="Master serial device (default: auto-detect)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--csv", help="write the records to this CSV file")
+    parser.add_argument("--clear", action="store_true", help="empty the journal after a complete download")
+    args = parser.parse_args(argv)
+
+    port = args.port
+    if not port:
+        try:
+            from .com_ports import discover_mcu_ports
+        except Exception:
+            try:
+                from app.com_ports import discover_mcu_ports
+            except Exception:
+                from com_ports import discover_mcu_ports
+        port = discover_mcu_ports(args.baud).get("master")
+        if not port:
+            print("Master not found", file=sys.stderr)
+            return 1
+
+    journal = download(port, args.baud, clear=args.clear)
+    print(f"{port}: {journal.summary()}")
+    for label, (high, low, seq) in journal.pins.items():
+        if high or low or seq:
+            print(f"  {label:<12} high={high} low={low} seq={seq}")
+    if args.csv:
+        write_csv(args.csv, journal)
+        print(f"saved {args.csv}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,227 @@
+"""Serial link probe: round-trip time, jitter and throughput per port.
+
+Uses the firmware `PING <seq> <payload>` and `BLAST <n> <size>` commands
+(both Master and Target answer them) to qualify USB hubs and cables:
+
+  * RTT percentiles from host write to the `PONG` line being read;
+  * jitter as the mean change between consecutive RTTs (RFC 3550 style);
+  * uplink/downlink spread: the device stamps each PONG with micros(), so the
+    host->device and device->host delays can be told apart up to a constant
+    clock offset (their spread is meaningful, their absolute value is not);
+  * sustained device->host bytes/sec and lost lines while streaming BLAST.
+
+Close the GUI first: the probe opens the ports itself.
+
+Usage:
+    python link_probe.py                       # auto-detect Master and Target
+    python link_probe.py /dev/ttyACM0 COM7 --count 500 --payload 32
+    python link_probe.py --concurrent --blast 2000 --size 200
+"""
+import argparse
+import json
+import statistics
+import sys
+import threading
+import time
+
+try:
+    import serial  # type: ignore
+except Exception:  # pragma: no cover - reported at runtime
+    serial = None
+
+try:
+    from .com_ports import discover_mcu_ports
+except Exception:
+    try:
+        from app.com_ports import discover_mcu_ports
+    except Exception:
+        from com_ports import discover_mcu_ports
+
+
+def _percentile(ordered: list[float], q: float) -> float:
+    if not ordered:
+        return float("nan")
+    return ordered[min(len(ordered) - 1, int(q * len(ordered)))]
+
+
+class LinkProbe:
+    """Runs PING and BLAST measurements against one port."""
+
+    def __init__(self, device: str, baud: int = 115200, reply_timeout: float = 1.0):
+        self.device = device
+        self.ser = serial.Serial(device, baudrate=baud, timeout=reply_timeout)
+        self.reply_timeout = reply_timeout
+
+    def close(self):
+        try:
+            self.ser.close()
+        except Exception:
+            pass
+
+    def _readline(self) -> tuple[str, int]:
+        raw = self.ser.readline()
+        return raw.decode("utf-8", errors="ignore").strip(), time.perf_counter_ns()
+
+    def ping(self, count: int, payload_size: int, interval_s: float) -> dict:
+        payload = ("x" * payload_size)[:100]  # firmware command buffer is 128 bytes
+        self.ser.reset_input_buffer()
+        rtts_ms, up_us, down_us = [], [], []
+        lost = 0
+        for seq in range(count):
+            t_send = time.perf_counter_ns()
+            self.ser.write(f"PING {seq} {payload}\n".encode("ascii"))
+            deadline = time.monotonic() + self.reply_timeout
+            while True:
+                line, t_recv = self._readline()
+                parts = line.split()
+                if len(parts) >= 4 and parts[1] == "PONG" and parts[2] == str(seq):
+                    rtts_ms.append((t_recv - t_send) / 1e6)
+                    device_us = int(parts[3])
+                    up_us.append(device_us - t_send / 1000.0)
+                    down_us.append(t_recv / 1000.0 - device_us)
+                    break
+                if time.monotonic() > deadline:
+                    lost += 1
+                    break
+            if interval_s > 0:
+                time.sleep(interval_s)
+
+        ordered = sorted(rtts_ms)
+        jitter = (statistics.fmean(abs(b - a) for a, b in zip(rtts_ms, rtts_ms[1:]))
+                  if len(rtts_ms) > 1 else 0.0)
+        return {
+            "sent": count,
+            "lost": lost,
+            "rtt_min_ms": ordered[0] if ordered else float("nan"),
+            "rtt_p50_ms": _percentile(ordered, 0.50),
+            "rtt_p90_ms": _percentile(ordered, 0.90),
+            "rtt_p99_ms": _percentile(ordered, 0.99),
+            "rtt_max_ms": ordered[-1] if ordered else float("nan"),
+            "jitter_ms": jitter,
+            "uplink_spread_ms": (statistics.pstdev(up_us) / 1000.0) if len(up_us) > 1 else 0.0,
+            "downlink_spread_ms": (statistics.pstdev(down_us) / 1000.0) if len(down_us) > 1 else 0.0,
+        }
+
+    def blast(self, lines: int, size: int) -> dict:
+        self.ser.reset_input_buffer()
+        t_send = time.perf_counter_ns()
+        self.ser.write(f"BLAST {lines} {size}\n".encode("ascii"))
+        received, nbytes = set(), 0
+        t_first = t_last = None
+        device_elapsed_us = None
+        deadline = time.monotonic() + self.reply_timeout + lines * 0.01
+        while time.monotonic() < deadline:
+            raw = self.ser.readline()
+            t = time.perf_counter_ns()
+            if not raw:
+                continue
+            parts = raw.split(maxsplit=4)
+            if len(parts) >= 3 and parts[1] == b"BLAST":
+                if t_first is None:
+                    t_first = t
+                t_last = t
+                nbytes += len(raw)
+                try:
+                    received.add(int(parts[2]))
+                except ValueError:
+                    pass
+            elif len(parts) >= 4 and parts[1] == b"BLAST_END":
+                device_elapsed_us = int(parts[3])
+                break
+        host_s = ((t_last - t_first) / 1e9) if t_first is not None and t_last != t_first else 0.0
+        return {
+            "lines": lines,
+            "size": size,
+            "received": len(received),
+            "lost": lines - len(received),
+            "bytes": nbytes,
+            "first_line_ms": ((t_first - t_send) / 1e6) if t_first is not None else float("nan"),
+            "host_bytes_per_s": (nbytes / host_s) if host_s else float("nan"),
+            "device_bytes_per_s": (nbytes / (device_elapsed_us / 1e6)) if device_elapsed_us else float("nan"),
+            "complete": device_elapsed_us is not None,
+        }
+
+
+def probe_port(device: str, args) -> dict:
+    result = {"port": device}
+    try:
+        probe = LinkProbe(device, args.baud)
+    except Exception as e:
+        result["error"] = str(e)
+        return result
+    try:
+        result["ping"] = probe.ping(args.count, args.payload, args.interval / 1000.0)
+        if args.blast > 0:
+            result["blast"] = probe.blast(args.blast, args.size)
+    except Exception as e:
+        result["error"] = str(e)
+    finally:
+        probe.close()
+    return result
+
+
+def _print_result(r: dict):
+    print(f"== {r['port']}")
+    if "error" in r:
+        print(f"   error: {r['error']}")
+    p = r.get("ping")
+    if p:
+        print(f"   PING  sent={p['sent']} lost={p['lost']}")
+        print(f"         rtt ms  min={p['rtt_min_ms']:.3f} p50={p['rtt_p50_ms']:.3f} p90={p['rtt_p90_ms']:.3f}"
+              f" p99={p['rtt_p99_ms']:.3f} max={p['rtt_max_ms']:.3f}")
+        print(f"         jitter={p['jitter_ms']:.3f} ms  uplink spread={p['uplink_spread_ms']:.3f} ms"
+              f"  downlink spread={p['downlink_spread_ms']:.3f} ms")
+    b = r.get("blast")
+    if b:
+        print(f"   BLAST lines={b['lines']}x{b['size']}B received={b['received']} lost={b['lost']}"
+              f"{'' if b['complete'] else ' (no BLAST_END)'}")
+        print(f"         first line {b['first_line_ms']:.2f} ms  host {b['host_bytes_per_s'] / 1024:.1f} KiB/s"
+              f"  device {b['device_bytes_per_s'] / 1024:.1f} KiB/s")
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Measure serial RTT, jitter and throughput of tester ports")
+    parser.add_argument("ports", nargs="*", help="serial devices (default: auto-detect Master and Target)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--count", type=int, default=200, help="PING round trips per port")
+    parser.add_argument("--payload", type=int, default=16, help="PING payload bytes (max 100)")
+    parser.add_argument("--interval", type=float, default=0.0, help="pause between PINGs, ms")
+    parser.add_argument("--blast", type=int, default=1000, help="BLAST lines per port (0 to skip)")
+    parser.add_argument("--size", type=int, default=128, help="BLAST filler bytes per line (max 256)")
+    parser.add_argument("--concurrent", action="store_true", help="probe all ports at once (hub contention)")
+    parser.add_argument("--json", action="store_true", help="print results as JSON")
+    args = parser.parse_args(argv)
+
+    if serial is None:
+        print("pyserial is not installed")
+        return 2
+    ports = args.ports
+    if not ports:
+        found = discover_mcu_ports()
+        ports = [p for p in (found.get("master"), found.get("target")) if p]
+        if not ports:
+            print("No Master or Target found; pass port names explicitly")
+            return 1
+
+    results: list[dict] = [None] * len(ports)
+    if args.concurrent:
+        def worker(i, dev):
+            results[i] = probe_port(dev, args)
+        threads = [threading.Thread(target=worker, args=(i, dev)) for i, dev in enumerate(ports)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+    else:
+        results = [probe_port(dev, args) for dev in ports]
+
+    if args.json:
+        print(json.dumps(results, indent=1))
+    else:
+        for r in results:
+            _print_result(r)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,10 +1,18 @@
-import ctypes
+import argparse
 import os
 import sys
 import traceback
 
+# Startup timing starts before the heavy imports (see startup.py)
+try:
+    from app.startup import TIMER
+except Exception:
+    from startup import TIMER
+
 from PySide6.QtWidgets import QApplication
 
+TIMER.mark("qt")
+
 # Be resilient to different run contexts (package vs script)
 try:
     from app.ui import MainWindow
@@ -14,6 +22,8 @@ except Exception:
     except Exception:
         # Show an error box to make failures visible when launching the EXE
         try:
+            import ctypes
+
             ctypes.windll.user32.MessageBoxW(
                 0,
                 "Failed to import UI modules.\n" + traceback.format_exc(),
@@ -25,11 +35,45 @@ except Exception:
         raise
 
 
+def parse_args(argv):
+    parser = argparse.ArgumentParser(description="C!N Tester GUI")
+    parser.add_argument("--replay", metavar="CAPTURE", help="feed a .cncap serial capture through the GUI instead of the boards")
+    parser.add_argument("--speed", type=float, default=1.0, help="replay time scale (1 real time, 0 as fast as possible)")
+    parser.add_argument("--exit", action="store_true", help="quit after the replay and print its summary")
+    args, _qt_args = parser.parse_known_args(argv[1:])
+    return args
+
+
+def start_replay(w, args):
+    from PySide6.QtCore import QTimer
+
+    try:
+        from app.serial_capture import CaptureReplay
+    except Exception:
+        from serial_capture import CaptureReplay
+
+    replay = CaptureReplay(w, args.replay, args.speed)
+
+    def done(summary):
+        print(summary)
+        w._log_info(summary)
+        if args.exit:
+            QApplication.quit()
+
+    replay.finished.connect(done)
+    QTimer.singleShot(0, replay.start)
+
+
 def main():
     try:
+        args = parse_args(sys.argv)
         app = QApplication(sys.argv)
-        w = MainWindow()
-        w.show()
+        TIMER.mark("ui")  # ui import + QApplication
+        w = MainWindow(startup_timer=TIMER)
+        TIMER.mark("window")
+        if args.replay:
+            start_replay(w, args)
+        w.show()  # serial, metrics and port scan start after the first paint
 
         sys.exit(app.exec())
         # app.setQuitOnLastWindowClosed(False)
@@ -61,6 +105,8 @@ def main():
         except Exception:
             pass
         try:
+            import ctypes
+
             ctypes.windll.user32.MessageBoxW(
                 0,
                 "An unhandled error occurred while starting.\nLog: " + log_path + "\n\n" + traceback.format_exc(),
@@ -0,0 +1,287 @@
+"""In-process station metrics exposed in Prometheus text format.
+
+Counters, gauges, histograms and windowed summaries are updated from the GUI
+thread, SerialReader and FlashWorker threads; each update takes the registry
+lock for a few microseconds only. Scrapes are served by a daemon thread
+bound to localhost (or a Unix socket), so the GUI never waits on a scraper.
+
+Endpoint selection (env CN_TESTER_METRICS or QSettings 'metrics_endpoint'):
+    127.0.0.1:9464   HTTP on localhost (default)
+    unix:/path/sock  HTTP over a Unix socket
+    off              disabled
+"""
+import bisect
+import os
+import threading
+import time
+from collections import deque
+
+DEFAULT_ENDPOINT = "127.0.0.1:9464"
+
+
+def _fmt_labels(names: tuple, values: tuple, extra: str = "") -> str:
+    parts = [f'{n}="{str(v).replace(chr(92), chr(92) * 2).replace(chr(34), chr(92) + chr(34))}"'
+             for n, v in zip(names, values)]
+    if extra:
+        parts.append(extra)
+    return "{" + ",".join(parts) + "}" if parts else ""
+
+
+def _fmt_value(v: float) -> str:
+    if v == float("inf"):
+        return "+Inf"
+    return repr(float(v)) if isinstance(v, float) else str(v)
+
+
+class _Metric:
+    kind = "untyped"
+
+    def __init__(self, registry, name: str, doc: str, labels: tuple = ()):
+        self._lock = registry.lock
+        self.name = name
+        self.doc = doc
+        self.label_names = tuple(labels)
+
+    def header(self) -> list[str]:
+        return [f"# HELP {self.name} {self.doc}", f"# TYPE {self.name} {self.kind}"]
+
+
+class Counter(_Metric):
+    kind = "counter"
+
+    def __init__(self, registry, name, doc, labels=()):
+        super().__init__(registry, name, doc, labels)
+        self._values: dict[tuple, float] = {} if labels else {(): 0}
+
+    def inc(self, *label_values, amount: float = 1):
+        with self._lock:
+            self._values[label_values] = self._values.get(label_values, 0) + amount
+
+    def samples(self) -> list[str]:
+        return [f"{self.name}{_fmt_labels(self.label_names, k)} {_fmt_value(v)}"
+                for k, v in sorted(self._values.items())]
+
+
+class Gauge(_Metric):
+    kind = "gauge"
+
+    def __init__(self, registry, name, doc, labels=(), fn=None):
+        super().__init__(registry, name, doc, labels)
+        self._values: dict[tuple, float] = {}
+        self._fn = fn  # computed at scrape time when given
+
+    def set(self, value: float, *label_values):
+        with self._lock:
+            self._values[label_values] = value
+
+    def inc(self, *label_values, amount: float = 1):
+        with self._lock:
+            self._values[label_values] = self._values.get(label_values, 0) + amount
+
+    def samples(self) -> list[str]:
+        values = {(): self._fn()} if self._fn else self._values
+        return [f"{self.name}{_fmt_labels(self.label_names, k)} {_fmt_value(v)}"
+                for k, v in sorted(values.items())]
+
+
+class Histogram(_Metric):
+    kind = "histogram"
+
+    def __init__(self, registry, name, doc, labels=(), buckets=(0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60)):
+        super().__init__(registry, name, doc, labels)
+        self.buckets = tuple(sorted(buckets))
+        self._series: dict[tuple, list] = {}  # labels -> [bucket counts..., sum, count]
+
+    def observe(self, value: float, *label_values):
+        with self._lock:
+            s = self._series.get(label_values)
+            if s is None:
+                s = self._series[label_values] = [0] * len(self.buckets) + [0.0, 0]
+            i = bisect.bisect_left(self.buckets, value)
+            if i < len(self.buckets):
+                s[i] += 1
+            s[-2] += value
+            s[-1] += 1
+
+    def samples(self) -> list[str]:
+        out = []
+        for k, s in sorted(self._series.items()):
+            acc = 0
+            for b, c in zip(self.buckets, s):
+                acc += c
+                le = 'le="%s"' % _fmt_value(float(b))
+                out.append(f"{self.name}_bucket{_fmt_labels(self.label_names, k, le)} {acc}")
+            le = 'le="+Inf"'
+            out.append(f"{self.name}_bucket{_fmt_labels(self.label_names, k, le)} {s[-1]}")
+            out.append(f"{self.name}_sum{_fmt_labels(self.label_names, k)} {_fmt_value(s[-2])}")
+            out.append(f"{self.name}_count{_fmt_labels(self.label_names, k)} {s[-1]}")
+        return out
+
+
+class Summary(_Metric):
+    """Quantiles over the last `window` observations per label set."""
+    kind = "summary"
+
+    def __init__(self, registry, name, doc, labels=(), quantiles=(0.5, 0.9, 0.99), window=500):
+        super().__init__(registry, name, doc, labels)
+        self.quantiles = quantiles
+        self.window = window
+        self._series: dict[tuple, list] = {}  # labels -> [deque, sum, count]
+
+    def observe(self, value: float, *label_values):
+        with self._lock:
+            s = self._series.get(label_values)
+            if s is None:
+                s = self._series[label_values] = [deque(maxlen=self.window), 0.0, 0]
+            s[0].append(value)
+            s[1] += value
+            s[2] += 1
+
+    def samples(self) -> list[str]:
+        out = []
+        for k, (window, total, count) in sorted(self._series.items()):
+            ordered = sorted(window)
+            for q in self.quantiles:
+                v = ordered[min(len(ordered) - 1, int(q * len(ordered)))] if ordered else float("nan")
+                quantile = 'quantile="%s"' % q
+                out.append(f"{self.name}{_fmt_labels(self.label_names, k, quantile)} {_fmt_value(v)}")
+            out.append(f"{self.name}_sum{_fmt_labels(self.label_names, k)} {_fmt_value(total)}")
+            out.append(f"{self.name}_count{_fmt_labels(self.label_names, k)} {count}")
+        return out
+
+
+class Registry:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self._metrics: list[_Metric] = []
+
+    def _add(self, metric):
+        self._metrics.append(metric)
+        return metric
+
+    def counter(self, name, doc, labels=()):
+        return self._add(Counter(self, name, doc, labels))
+
+    def gauge(self, name, doc, labels=(), fn=None):
+        return self._add(Gauge(self, name, doc, labels, fn))
+
+    def histogram(self, name, doc, labels=(), **kw):
+        return self._add(Histogram(self, name, doc, labels, **kw))
+
+    def summary(self, name, doc, labels=(), **kw):
+        return self._add(Summary(self, name, doc, labels, **kw))
+
+    def render(self) -> str:
+        lines = []
+        with self.lock:
+            for m in self._metrics:
+                lines.extend(m.header())
+                lines.extend(m.samples())
+        return "\n".join(lines) + "\n"
+
+
+REGISTRY = Registry()
+
+# --- Station metrics ---
+_completed = deque()  # monotonic timestamps of finished runs (last hour)
+
+
+def _boards_per_hour() -> float:
+    cutoff = time.monotonic() - 3600.0
+    while _completed and _completed[0] < cutoff:
+        _completed.popleft()
+    return float(len(_completed))
+
+
+RUNS = REGISTRY.counter("cn_tester_runs_total", "Finished test runs by result", ("result",))
+RUN_DURATION = REGISTRY.histogram("cn_tester_run_duration_seconds", "Test run duration from Run to verdict",
+                                  buckets=(2, 4, 6, 8, 10, 12, 15, 20, 30, 60))
+STAGE_LATENCY = REGISTRY.summary("cn_tester_stage_latency_seconds",
+                                 "Stage latency from AWAIT to verdict line", ("stage",))
+BOARDS_PER_HOUR = REGISTRY.gauge("cn_tester_boards_per_hour", "Runs finished in the last hour",
+                                 fn=_boards_per_hour)
+PASS_RATE = REGISTRY.gauge("cn_tester_pass_rate", "Fraction of finished runs that passed",
+                           fn=lambda: (RUNS._values.get(("pass",), 0) /
+                                       max(1, sum(RUNS._values.values()))))
+FLASH_DURATION = REGISTRY.histogram("cn_tester_flash_duration_seconds", "Target flash duration", ("result",),
+                                    buckets=(2, 4, 6, 8, 10, 15, 20, 30, 60))
+PORT_RECONNECTS = REGISTRY.counter("cn_tester_port_reconnects_total",
+                                   "Serial port reopen attempts that succeeded after a loss", ("role",))
+RECOVERIES = REGISTRY.counter("cn_tester_recoveries_total",
+                              "Session watchdog recovery steps taken on stalled runs", ("step",))
+
+SPC_OUT_OF_CONTROL = REGISTRY.gauge("cn_tester_spc_out_of_control",
+                                    "1 while a pin's EWMA chart is above its control limit", ("pin", "stat"))
+
+
+def set_spc_alarms(alarms: list[tuple[str, str]]):
+    """Publish the (pin, stat) charts currently out of control; cleared ones drop out."""
+    with REGISTRY.lock:
+        SPC_OUT_OF_CONTROL._values = {key: 1 for key in alarms}
+
+
+def record_run(result: str, duration_s: float | None):
+    RUNS.inc(result)
+    if duration_s is not None:
+        RUN_DURATION.observe(duration_s)
+    with REGISTRY.lock:
+        _completed.append(time.monotonic())
+
+
+# --- Server ---
+def _server_classes():
+    """HTTP handler and Unix server classes. http.server is imported here, on
+    the first start, so importing this module stays cheap at app startup."""
+    import socketserver
+    from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+    class _Handler(BaseHTTPRequestHandler):
+        def do_GET(self):
+            if self.path.split("?", 1)[0] not in ("/", "/metrics"):
+                self.send_error(404)
+                return
+            body = REGISTRY.render().encode("utf-8")
+            self.send_response(200)
+            self.send_header("Content-Type", "text/plain; version=0.0.4; charset=utf-8")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def address_string(self):
+            return "local"
+
+        def log_message(self, fmt, *args):
+            pass  # keep scrapes out of the console
+
+    class _UnixHTTPServer(socketserver.ThreadingMixIn, socketserver.UnixStreamServer):
+        daemon_threads = True
+
+        def get_request(self):
+            request, _ = super().get_request()
+            return request, ("local", 0)
+
+    return _Handler, _UnixHTTPServer, ThreadingHTTPServer
+
+
+def start_server(endpoint: str | None = None):
+    """Start serving metrics in a daemon thread. Returns the server or None if disabled."""
+    endpoint = (endpoint or os.environ.get("CN_TESTER_METRICS") or DEFAULT_ENDPOINT).strip()
+    if endpoint.lower() in ("", "off", "0", "none"):
+        return None
+    handler, unix_server, tcp_server = _server_classes()
+    if endpoint.startswith("unix:"):
+        path = endpoint[5:]
+        try:
+            os.unlink(path)
+        except OSError:
+            pass
+        server = unix_server(path, handler)
+    else:
+        host, _, port = endpoint.rpartition(":")
+        host = host or "127.0.0.1"
+        if host not in ("127.0.0.1", "localhost", "::1"):
+            raise ValueError(f"Metrics endpoint must be local, got {host}")
+        server = tcp_server((host, int(port)), handler)
+        server.daemon_threads = True
+    threading.Thread(target=server.serve_forever, name="metrics", daemon=True).start()
+    return server
@@ -0,0 +1,956 @@
+"""Virtual-time discrete-event simulator of the tester protocol.
+
+Models the Master and Target firmware state machines, USB CDC latency and the
+host pacing of `SerialReader`/`MainWindow` on a virtual clock, so timing
+constants (SEQ_MS, DEBOUNCE_MS, sequence timeout, heartbeats, flash timeout)
+can be evaluated without touching the fixture.
+
+The models mirror the firmware and app behaviour closely, including the
+details that dominate cycle time:
+  * the Master handles one command per loop() iteration;
+  * the Target blocks in delay(SEQ_MS) while pulsing a pin;
+  * SerialReader only drains its outgoing queue after readline() returns,
+    i.e. on an incoming line or on the 100 ms read timeout.
+
+Usage:
+    python protocol_sim.py --cycles 2000
+    python protocol_sim.py --set seq_ms=100 --sweep pin_timeout_ms=500,1000 --set fast=1
+    python protocol_sim.py --fault drop_rate=0.001 --fault noisy_rate=0.02
+    python protocol_sim.py --sweep paced=0,1     # legacy vs HELLO?-negotiated pacing
+    python protocol_sim.py --fault drop_rate=0.002 --sweep watchdog=0,1   # session watchdog recovery
+"""
+import argparse
+import heapq
+import math
+import multiprocessing
+import os
+import random
+import statistics
+import time
+from dataclasses import dataclass, fields, replace
+
+try:
+    from .session_watchdog import GIVE_UP, SessionWatchdog
+except Exception:
+    try:
+        from app.session_watchdog import GIVE_UP, SessionWatchdog
+    except Exception:
+        from session_watchdog import GIVE_UP, SessionWatchdog
+
+PIN_LABELS = [
+    "P0_13(VCC)", "P0_31", "P0_29", "P0_02", "P1_15", "P1_13", "P1_11", "P0_10", "P0_09",
+    "P1_06", "P1_04", "P0_11", "P1_00", "P0_24", "P0_22", "P0_20", "P0_17", "P0_08", "P0_06",
+]
+
+
+@dataclass
+class SimConfig:
+    # Firmware timing (ms)
+    seq_ms: float = 150.0              # Target: pulse width per pin in SEQUENCE
+    debounce_ms: float = 50.0          # Master: BUTTON_PIN debounce
+    pin_timeout_ms: float = 1000.0     # Master: SEQUENCE wait for a pin after NEXT_PIN
+    heartbeat_ms: float = 500.0        # both: 'STAGE — IDLE: OK' period
+    await_pin_ms: float = 500.0        # Master: 'AWAIT_PIN' reprint period
+    handshake_ms: float = 200.0        # both: 'Hello! I am ...' period
+    loop_us: float = 20.0              # Master: loop() iteration time
+    # Host timing
+    reader_timeout_ms: float = 100.0   # SerialReader readline() timeout
+    reader_sleep_ms: float = 10.0      # SerialReader msleep() after an empty read
+    host_ui_ms: float = 0.5            # median GUI-thread handling latency per line
+    paced: bool = False                # HELLO? negotiated: Target acks release the Master checks
+    watchdog: bool = False             # session watchdog: stage deadlines and recovery steps
+    watchdog_poll_ms: float = 250.0    # MainWindow polls the watchdog on a QTimer
+    flash_timeout_s: float = 12.0      # FlashWorker port wait timeout
+    # USB CDC latency (lognormal, per line)
+    usb_median_ms: float = 1.0
+    usb_sigma: float = 0.6
+    # Operator
+    fast: bool = False                 # START FAST (fail-fast) instead of START FULL
+    start_by_button: bool = False      # start cycles with BUTTON_PIN instead of Run
+    button_hold_ms: float = 120.0      # median press duration
+    max_cycle_ms: float = 60000.0      # cycles without a verdict count as hangs
+    # Flash phase (Flash&Run)
+    flash: bool = False
+    dfu_enum_ms: float = 1500.0        # median DFU port enumeration time
+    flash_ms: float = 6000.0           # median nrfutil upload time
+    app_enum_ms: float = 1500.0        # median Target CDC enumeration after flashing
+    # Injectable faults
+    drop_rate: float = 0.0             # probability a line is lost on the link
+    noisy_rate: float = 0.0            # probability a Master pin read is flipped
+    defect_rate: float = 0.0           # probability a board has an open or short
+    slow_enum_rate: float = 0.0        # probability an enumeration is slow
+    slow_enum_ms: float = 15000.0      # enumeration time when slow
+
+
+class Sim:
+    """Minimal event queue on a virtual millisecond clock."""
+
+    def __init__(self, rng: random.Random):
+        self.now = 0.0
+        self.rng = rng
+        self.events = 0
+        self.stopped = False
+        self._q = []
+        self._seq = 0
+
+    def at(self, t: float, fn, *args):
+        self._seq += 1
+        heapq.heappush(self._q, (t, self._seq, fn, args))
+
+    def after(self, dt: float, fn, *args):
+        self.at(self.now + dt, fn, *args)
+
+    def lognormal(self, mu: float, sigma: float) -> float:
+        return math.exp(self.rng.gauss(mu, sigma))
+
+    def stop(self):
+        self.stopped = True
+
+    def run(self, limit: float):
+        """Process events up to `limit` ms or until stop() is called."""
+        q = self._q
+        pop = heapq.heappop
+        self.stopped = False
+        n = 0
+        while q and q[0][0] <= limit:
+            t, _, fn, args = pop(q)
+            self.now = t
+            n += 1
+            fn(*args)
+            if self.stopped:
+                break
+        else:
+            self.now = limit
+        self.events += n
+
+    def run_while(self, condition, limit: float, step: float = 50.0):
+        while condition() and self.now < limit:
+            self.run(min(self.now + step, limit))
+
+    def clear(self):
+        self._q.clear()
+
+
+class Link:
+    """One direction of a USB CDC connection: in-order, lognormal latency, optional drops."""
+
+    def __init__(self, sim: Sim, cfg: SimConfig, stats: dict):
+        self.sim = sim
+        self.mu = math.log(cfg.usb_median_ms)
+        self.sigma = cfg.usb_sigma
+        self.drop_rate = cfg.drop_rate
+        self.stats = stats
+        self._last = 0.0
+
+    def send(self, line: str, deliver):
+        if self.drop_rate and self.sim.rng.random() < self.drop_rate:
+            self.stats["dropped"] += 1
+            return
+        t = max(self.sim.now + self.sim.lognormal(self.mu, self.sigma), self._last)
+        self._last = t
+        self.sim.at(t, deliver, line)
+
+
+class Fixture:
+    """Pin wiring between Target outputs and Master inputs, with board defects."""
+
+    def __init__(self, sim: Sim, cfg: SimConfig, n: int):
+        self.sim = sim
+        self.noisy_rate = cfg.noisy_rate
+        self.drive = [False] * n
+        self.open: set[int] = set()
+        self.short: tuple[int, int] | None = None
+        self.listener = None
+
+    def set_defect(self, rng: random.Random, rate: float) -> bool:
+        self.open.clear()
+        self.short = None
+        if not rate or rng.random() >= rate:
+            return False
+        n = len(self.drive)
+        if rng.random() < 0.5:
+            self.open.add(rng.randrange(n))
+        else:
+            a = rng.randrange(n - 1)
+            self.short = (a, a + 1)
+        return True
+
+    def write(self, i: int, level: bool):
+        if self.drive[i] != level:
+            self.drive[i] = level
+            if self.listener:
+                self.listener()
+
+    def write_all(self, level: bool):
+        self.drive = [level] * len(self.drive)
+        if self.listener:
+            self.listener()
+
+    def read(self, i: int) -> bool:
+        level = False if i in self.open else self.drive[i]
+        if self.short and i in self.short:
+            a, b = self.short
+            level = self.drive[a] or self.drive[b]
+        if self.noisy_rate and self.sim.rng.random() < self.noisy_rate:
+            level = not level
+        return level
+
+
+# --- Firmware models ---
+
+M_HANDSHAKE, M_WAIT_BUTTON, M_ALL_HIGH, M_ALL_LOW, M_SEQUENCE, M_SUCCESS, M_FAIL = range(7)
+
+
+class MasterModel:
+    """Event-driven port of master_firmware loop(): one step per wake-up."""
+
+    def __init__(self, sim: Sim, cfg: SimConfig, fixture: Fixture):
+        self.sim = sim
+        self.cfg = cfg
+        self.fx = fixture
+        self.n = len(fixture.drive)
+        self.tx: Link | None = None
+        self.host_rx = None
+        self.reset_target = None  # pulses the Target's reset line (TargetModel.reset)
+        self.rx: list[str] = []
+        self._wake_at = None
+        fixture.listener = self._on_pin_change
+        self.reset()
+
+    def reset(self):
+        self.rx.clear()
+        self._wake_at = None
+        self.state = M_HANDSHAKE
+        self.state_start = self.sim.now
+        self.last_blink = 0.0
+        self.last_await_print = -1e9  # `static` in loop(): survives runs
+        self.expected = 0
+        self.fast = False
+        self.defects: set[int] = set()
+        self.pin_start = 0.0
+        self.flags = dict.fromkeys(("start", "all_high", "all_low", "seq", "next"), False)
+        self.begin = dict.fromkeys(("all_high", "all_low", "seq", "fail"), False)
+        self.button_low_since = None
+        self.button_released_at = None
+        self._wake(0)
+
+    def print(self, line: str):
+        self.tx.send(line, self.host_rx)
+
+    def on_rx(self, line: str):
+        self.rx.append(line)
+        self._wake(self.cfg.loop_us / 1000.0)
+
+    def press_button(self, hold_ms: float):
+        self.button_low_since = self.sim.now
+        self.button_released_at = self.sim.now + hold_ms
+        self._wake(self.cfg.debounce_ms + self.cfg.loop_us / 1000.0)
+
+    def _on_pin_change(self):
+        if self.state == M_SEQUENCE and self.flags["next"]:
+            self._wake(self.cfg.loop_us / 1000.0)
+
+    def _wake(self, dt: float):
+        t = self.sim.now + dt
+        if self._wake_at is not None and self._wake_at <= t:
+            return
+        self._wake_at = t
+        self.sim.at(t, self._step, t)
+
+    def _to(self, s: int):
+        self.state = s
+        self.state_start = self.sim.now
+
+    def _step(self, t: float):
+        if self._wake_at != t:
+            return  # superseded by an earlier wake-up
+        self._wake_at = None
+        now = self.sim.now
+        loop_ms = self.cfg.loop_us / 1000.0
+        f, b = self.flags, self.begin
+        if self.rx:
+            cmd = self.rx.pop(0).upper()
+            if cmd == "INIT":
+                abandon = self.state in (M_ALL_HIGH, M_ALL_LOW, M_SEQUENCE)
+                if abandon:
+                    self.print("Master: RUN ABORTED")
+                    f["seq"] = f["next"] = False
+                if abandon or self.state in (M_HANDSHAKE, M_WAIT_BUTTON, M_FAIL, M_SUCCESS):
+                    self.print("Master: READY")
+                    self._to(M_WAIT_BUTTON)
+            elif cmd == "RESET_TARGET":
+                self.print("Master: SENT RESET")
+                if self.reset_target:
+                    self.sim.after(100.0, self.reset_target)  # 100 ms pulse, Target boots on release
+            elif cmd == "START" or cmd.startswith("START "):
+                mode = cmd[5:].strip()
+                if mode in ("FAST", "FULL"):
+                    self.fast = mode == "FAST"
+                f["start"] = True
+                self.print(f"Master: START command received. MODE={'FAST' if self.fast else 'FULL'}")
+            elif cmd == "START_ALL_HIGH":
+                f["all_high"] = True
+            elif cmd == "START_ALL_LOW":
+                f["all_low"] = True
+            elif cmd == "START_SEQUENCE":
+                f["seq"] = True
+            elif cmd == "NEXT_PIN":
+                f["next"] = True
+                self.pin_start = now
+            if self.rx:
+                self._wake(loop_ms)
+
+        pressed = (self.button_low_since is not None
+                   and now - self.button_low_since > self.cfg.debounce_ms)
+        nxt = None  # next timer-driven wake-up
+
+        if self.state == M_HANDSHAKE:
+            if now - self.last_blink >= self.cfg.handshake_ms:
+                self.print("Hello! I am Master!")
+                self.last_blink = now
+            nxt = self.last_blink + self.cfg.handshake_ms
+
+        elif self.state == M_WAIT_BUTTON:
+            if now - self.last_blink >= self.cfg.heartbeat_ms:
+                self.print("Master: STAGE — IDLE: OK")
+                self.last_blink = now
+            nxt = self.last_blink + self.cfg.heartbeat_ms
+            if pressed:
+                # while (digitalRead(BUTTON_PIN) == LOW) delay(10);
+                release = max(self.button_released_at, now)
+                self.button_low_since = None
+                self.sim.at(release + 10.0, self.print, "Master: BUTTON_PRESSED")
+            if f["start"]:
+                f["start"] = False
+                self.print("Master: START")
+                self.expected = 0
+                self.defects.clear()
+                b["all_high"] = b["fail"] = False
+                f["all_high"] = f["all_low"] = f["seq"] = f["next"] = False
+                self._to(M_ALL_HIGH)
+                nxt = now + loop_ms
+
+        elif self.state in (M_ALL_HIGH, M_ALL_LOW):
+            high = self.state == M_ALL_HIGH
+            name, key = ("ALL_HIGH", "all_high") if high else ("ALL_LOW", "all_low")
+            if not b[key]:
+                self.print(f"Master: STAGE — {name}: AWAIT")
+                b[key] = True
+            if f[key]:
+                f[key] = False
+                self.print(f"Master: STAGE — {name}: BEGIN")
+                levels = [self.fx.read(i) for i in range(self.n)]
+                bad = [PIN_LABELS[i] for i, v in enumerate(levels) if v != high]
+                if not bad:
+                    self.print(f"Master: STAGE — {name}: OK")
+                else:
+                    what = "LOW_PINS" if high else "HIGH_PINS"
+                    self.print(f"Master: STAGE — {name}: ERROR. {what}: " + ", ".join(bad))
+                    self.defects.update(i for i, v in enumerate(levels) if v != high)
+                if bad and self.fast:
+                    self._finish()
+                elif high:
+                    b["all_low"] = False
+                    self._to(M_ALL_LOW)
+                else:
+                    b["seq"] = False
+                    self._to(M_SEQUENCE)
+                nxt = now + loop_ms
+
+        elif self.state == M_SEQUENCE:
+            nxt = self._step_sequence(now, loop_ms)
+
+        elif self.state == M_SUCCESS:
+            self.print("Master: STAGE — SUCCESS: OK")
+            self._to(M_WAIT_BUTTON)
+            nxt = now + loop_ms
+
+        elif self.state == M_FAIL:
+            if not b["fail"]:
+                self.print("Master: FAIL")
+                b["fail"] = True
+            if pressed or f["start"]:
+                self.button_low_since = None
+                f["start"] = False
+                self.print("Master: START")
+                self.expected = 0
+                self.defects.clear()
+                for k in b:
+                    b[k] = False
+                for k in ("all_high", "all_low", "seq", "next"):
+                    f[k] = False
+                self._to(M_ALL_HIGH)
+                nxt = now + loop_ms
+
+        if nxt is not None:
+            self._wake(max(nxt - now, loop_ms))
+
+    def _finish(self):
+        verdict = "FAIL" if self.defects else "PASS"
+        self.print(f"Master: RESULT MODE={'FAST' if self.fast else 'FULL'} VERDICT={verdict}")
+        self.flags["seq"] = self.flags["next"] = False
+        self._to(M_FAIL if self.defects else M_SUCCESS)
+
+    def _pin_failed(self):
+        self.flags["next"] = False
+        self.expected += 1
+        if self.fast or self.expected >= self.n:
+            self._finish()
+
+    def _step_sequence(self, now: float, loop_ms: float):
+        f, b = self.flags, self.begin
+        if not b["seq"]:
+            self.print("Master: STAGE — SEQUENCE: AWAIT")
+            b["seq"] = True
+            f["seq"] = False
+            f["next"] = False
+        if not f["seq"]:
+            return None
+        if not f["next"]:
+            if now - self.last_await_print > self.cfg.await_pin_ms:
+                self.print(f"Master: STAGE — SEQUENCE: AWAIT_PIN — {PIN_LABELS[self.expected]}")
+                self.last_await_print = now
+            return self.last_await_print + self.cfg.await_pin_ms + loop_ms
+        high = [i for i in range(self.n) if self.fx.read(i)]
+        if len(high) > 1:
+            self.print("Master: STAGE — SEQUENCE: ERROR. FAIL_PINS: "
+                       + ", ".join(PIN_LABELS[i] for i in high))
+            self.defects.update(high)
+            self._pin_failed()
+            return now + loop_ms
+        if len(high) == 1:
+            f["next"] = False
+            self.print(f"Master: STAGE — SEQUENCE: OK — {PIN_LABELS[high[0]]} "
+                       f"settle_us={int((now - self.pin_start) * 1000)}")
+            if high[0] == self.expected:
+                self.expected += 1
+                if self.expected == self.n:
+                    self.print("Master: STAGE — SEQUENCE: DONE" if self.defects
+                               else "Master: STAGE — SEQUENCE: ALL OK")
+                    self._finish()
+            else:
+                self.print("Master: STAGE — SEQUENCE: ERROR. THE ORDER OF SEQUENCE IS VIOLATED. "
+                           f"EXPECTED: {PIN_LABELS[self.expected]}, RECEIVED {PIN_LABELS[high[0]]}")
+                self.defects.update((self.expected, high[0]))
+                self._pin_failed()
+            return now + loop_ms
+        if now - self.pin_start > self.cfg.pin_timeout_ms:
+            self.print(f"Master: STAGE — SEQUENCE: ERROR. TIMEOUT. EXPECTED: {PIN_LABELS[self.expected]}")
+            self.defects.add(self.expected)
+            self._pin_failed()
+            return now + loop_ms
+        # Polling for the pin: woken by a pin change or by the timeout
+        return self.pin_start + self.cfg.pin_timeout_ms + loop_ms
+
+
+class TargetModel:
+    """Port of target_firmware loop(); NEXT_PIN blocks for SEQ_MS."""
+
+    def __init__(self, sim: Sim, cfg: SimConfig, fixture: Fixture):
+        self.sim = sim
+        self.cfg = cfg
+        self.fx = fixture
+        self.tx: Link | None = None
+        self.host_rx = None
+        self.rx: list[str] = []
+        self.busy_until = 0.0
+        self._gen = 0
+        self.reset()
+
+    def reset(self):
+        self._gen += 1
+        self.handshake = True
+        self.seq_index = 0
+        self.rx.clear()
+        self.busy_until = self.sim.now
+        self.sim.after(0.0, self._tick, self._gen)
+
+    def print(self, line: str):
+        self.tx.send(line, self.host_rx)
+
+    def on_rx(self, line: str):
+        self.rx.append(line)
+        if len(self.rx) == 1:
+            self.sim.at(max(self.sim.now, self.busy_until), self._handle, self._gen)
+
+    def _tick(self, gen: int):
+        if gen != self._gen:
+            return
+        if self.sim.now >= self.busy_until:
+            if self.handshake:
+                self.print("Hello! I am Target!")
+            else:
+                self.print("Target: STAGE — IDLE: OK")
+        period = self.cfg.handshake_ms if self.handshake else self.cfg.heartbeat_ms
+        self.sim.after(period, self._tick, gen)
+
+    def _handle(self, gen: int):
+        if gen != self._gen or not self.rx:
+            return
+        cmd = self.rx.pop(0).upper()
+        if cmd == "INIT":
+            self.handshake = False
+            self.print("Target: READY")
+        elif cmd == "START_ALL_HIGH":
+            self.handshake = False
+            self.print("Target: STAGE — ALL_HIGH: BEGIN")
+            self.fx.write_all(True)
+            self.print("Target: STAGE — ALL_HIGH: OK")
+        elif cmd == "START_ALL_LOW":
+            self.handshake = False
+            self.print("Target: STAGE — ALL_LOW: BEGIN")
+            self.fx.write_all(False)
+            self.print("Target: STAGE — ALL_LOW: OK")
+        elif cmd == "START_SEQUENCE":
+            self.handshake = False
+            self.print("Target: STAGE — SEQUENCE: BEGIN")
+            self.seq_index = 0
+        elif cmd == "NEXT_PIN":
+            self.handshake = False
+            if self.seq_index < len(self.fx.drive):
+                i = self.seq_index
+                self.fx.write(i, True)
+                self.print(f"Target: PIN_UP {i}")
+                self.busy_until = self.sim.now + self.cfg.seq_ms
+                self.sim.at(self.busy_until, self._end_pulse, gen, i)
+                return
+        if self.rx:
+            self.sim.after(0.0, self._handle, gen)
+
+    def _end_pulse(self, gen: int, i: int):
+        if gen != self._gen:
+            return
+        self.fx.write(i, False)
+        self.seq_index += 1
+        if self.seq_index == len(self.fx.drive):
+            self.print("Target: STAGE — SEQUENCE: ALL OK")
+        if self.rx:
+            self._handle(gen)
+
+
+# --- Host models ---
+
+class ReaderModel:
+    """SerialReader: queued lines are written only after readline() returns."""
+
+    def __init__(self, sim: Sim, cfg: SimConfig, role: str, host):
+        self.sim = sim
+        self.cfg = cfg
+        self.role = role
+        self.host = host
+        self.tx: Link | None = None
+        self.device_rx = None
+        self.queue: list[str] = []
+        self.read_start = 0.0     # when the current readline() call began
+        self.sleep_until = 0.0
+        self._drain_at = None
+
+    def on_device_line(self, line: str):
+        now = self.sim.now
+        if now < self.sleep_until:
+            self.sim.at(self.sleep_until, self.on_device_line, line)
+            return
+        self.host.schedule_line(self.role, line)
+        self._drain()
+        self.read_start = now
+
+    def send_line(self, line: str):
+        self.queue.append(line)
+        if self._drain_at is None:
+            # Next readline() timeout boundary after now
+            period = self.cfg.reader_timeout_ms + self.cfg.reader_sleep_ms
+            first = self.read_start + self.cfg.reader_timeout_ms
+            k = max(0, math.ceil((self.sim.now - first) / period))
+            t = first + k * period
+            self._drain_at = t
+            self.sim.at(t, self._on_timeout, t)
+
+    def _on_timeout(self, t: float):
+        if self._drain_at != t:
+            return
+        self._drain()
+        self.sleep_until = self.sim.now + self.cfg.reader_sleep_ms
+        self.read_start = self.sleep_until
+
+    def _drain(self):
+        self._drain_at = None
+        while self.queue:
+            line = self.queue.pop(0)
+            self.host.on_tx(self.role, line)
+            self.tx.send(line, self.device_rx)
+
+
+class HostModel:
+    """Port of MainWindow.on_serial_line reactions that drive the protocol."""
+
+    def __init__(self, sim: Sim, cfg: SimConfig):
+        self.sim = sim
+        self.cfg = cfg
+        self.ui_mu = math.log(cfg.host_ui_ms)
+        self.master = ReaderModel(sim, cfg, "master", self)
+        self.target = ReaderModel(sim, cfg, "target", self)
+        self.master_ready = False
+        self.target_ready = False
+        self.running = False
+        self.verdict: str | None = None
+        self.lines = 0
+        self.pin_outstanding: float | None = None
+        self.pins_sent = 0
+        self.watchdog = SessionWatchdog() if cfg.watchdog else None
+        self._watch_gen = 0
+
+    def reset(self):
+        self.running = False
+        self.pin_outstanding = None
+        self.pins_sent = 0
+        self._stop_watch()
+        for reader in (self.master, self.target):
+            reader.queue.clear()
+            reader._drain_at = None
+
+    # Session watchdog (MainWindow._poll_watchdog)
+    def on_tx(self, role: str, line: str):
+        if self.watchdog:
+            self.watchdog.sent(role, line)
+
+    def _stage_awaited(self, stage: str):
+        if self.watchdog:
+            self.watchdog.stage(stage, self.sim.now / 1000.0)
+
+    def _stop_watch(self):
+        self._watch_gen += 1
+        if self.watchdog:
+            self.watchdog.disarm()
+
+    def _watch(self, gen: int):
+        if gen != self._watch_gen:
+            return
+        pending = self.watchdog.pending()
+        step = self.watchdog.poll(self.sim.now / 1000.0)
+        if step == GIVE_UP:
+            return  # left to the operator: counted as a hang
+        if step == "resend":
+            for role, line in pending:
+                (self.master if role == "master" else self.target).send_line(line)
+        elif step in ("reinit", "reset_target", "restart_port"):
+            if step == "reset_target":
+                self.master.send_line("RESET_TARGET")
+            elif step == "restart_port":
+                for reader in (self.master, self.target):
+                    reader.queue.clear()
+                    reader._drain_at = None
+            self.master_ready = self.target_ready = False
+            self.watchdog.restart(self.sim.now / 1000.0)
+            self.master.send_line("INIT")
+            self.target.send_line("INIT")
+        self.sim.after(self.cfg.watchdog_poll_ms, self._watch, gen)
+
+    def schedule_line(self, role: str, line: str):
+        self.sim.after(self.sim.lognormal(self.ui_mu, 0.5), self.on_line, role, line)
+
+    def run_test(self):
+        self.running = True
+        self.master_ready = self.target_ready = False
+        if self.watchdog:
+            self._stop_watch()
+            self.watchdog.arm(self.sim.now / 1000.0, reset_target=True)
+            self.sim.after(self.cfg.watchdog_poll_ms, self._watch, self._watch_gen)
+        self.master.send_line("INIT")
+        self.target.send_line("INIT")
+
+    def _both(self, cmd: str):
+        self.master.send_line(cmd)
+        self.target.send_line(cmd)
+
+    def _stage(self, cmd: str):
+        # Paced: the Target goes first, its OK line releases the Master
+        if self.cfg.paced:
+            self.target.send_line(cmd)
+        else:
+            self._both(cmd)
+
+    def _target_next_pin(self):
+        self.target.send_line("NEXT_PIN")
+        self.pin_outstanding = self.sim.now
+        self.pins_sent += 1
+
+    def _pin_verdict(self, failed: bool):
+        if not self.cfg.paced or self.pin_outstanding is None:
+            return
+        self.pin_outstanding = None
+        if self.pins_sent < len(PIN_LABELS) and not (failed and self.cfg.fast):
+            self._target_next_pin()
+
+    def on_line(self, role: str, line: str):
+        self.lines += 1
+        if self.watchdog:
+            self.watchdog.heard(role, line, self.sim.now / 1000.0)
+        if role == "master" and "Hello! I am Master!" in line:
+            self.master_ready = False
+            self.master.send_line("INIT")
+            return
+        if role == "target" and "Hello! I am Target!" in line:
+            self.target_ready = False
+            self.target.send_line("INIT")
+            return
+        u = line.upper()
+        if "READY" in u:
+            if role == "master":
+                self.master_ready = True
+            else:
+                self.target_ready = True
+            if self.master_ready and self.target_ready and self.running:
+                self.master.send_line("START FAST" if self.cfg.fast else "START FULL")
+            return
+        if role != "master":
+            if self.cfg.paced:
+                if "PIN_UP" in u:
+                    self.master.send_line("NEXT_PIN")
+                elif "ALL_HIGH: OK" in u:
+                    self.master.send_line("START_ALL_HIGH")
+                elif "ALL_LOW: OK" in u:
+                    self.master.send_line("START_ALL_LOW")
+            return
+        if u.startswith("MASTER: RESULT "):
+            return
+        if "BUTTON_PRESSED" in u:
+            self.run_test()
+            return
+        if "START" in u:
+            self.pin_outstanding = None
+            self.pins_sent = 0
+            return
+        if "ALL_HIGH" in u:
+            if "AWAIT" in u:
+                self._stage_awaited("all_high")
+                self._stage("START_ALL_HIGH")
+            return
+        if "ALL_LOW" in u:
+            if "AWAIT" in u:
+                self._stage_awaited("all_low")
+                self._stage("START_ALL_LOW")
+            return
+        if "SEQUENCE" in u:
+            if "AWAIT_PIN" in u:
+                self._stage_awaited("pin")
+                if not self.cfg.paced:
+                    self._both("NEXT_PIN")
+                elif self.pin_outstanding is None:
+                    self._target_next_pin()
+                elif self.sim.now - self.pin_outstanding > 2000.0:
+                    self.master.send_line("NEXT_PIN")
+            elif "AWAIT" in u:
+                self._stage_awaited("sequence")
+                self._both("START_SEQUENCE")
+            elif "ALL OK" in u:
+                pass
+            elif "OK" in u:
+                self._pin_verdict(failed=False)
+            elif "ERROR" in u:
+                self._pin_verdict(failed=True)
+            return
+        if "SUCCESS" in u:
+            self.verdict = "PASS"
+            self.running = False
+            self._stop_watch()
+            self.sim.stop()
+            return
+        if "FAIL" in u or "ERROR" in u:
+            self.verdict = "FAIL"
+            self.running = False
+            self._stop_watch()
+            self.sim.stop()
+
+
+# --- Runner ---
+
+def _percentile(sorted_vals: list[float], q: float) -> float:
+    if not sorted_vals:
+        return float("nan")
+    k = min(len(sorted_vals) - 1, max(0, int(round(q * (len(sorted_vals) - 1)))))
+    return sorted_vals[k]
+
+
+def _enum_ms(rng: random.Random, cfg: SimConfig, median: float) -> float:
+    if cfg.slow_enum_rate and rng.random() < cfg.slow_enum_rate:
+        return cfg.slow_enum_ms
+    return rng.lognormvariate(math.log(median), 0.3)
+
+
+def _simulate(cfg: SimConfig, cycles: int, seed: int):
+    """Simulate `cycles` test cycles; returns (counters, cycle times, detection times)."""
+    rng = random.Random(seed)
+    sim = Sim(rng)
+    link_stats = {"dropped": 0}
+    fx = Fixture(sim, cfg, len(PIN_LABELS))
+    master = MasterModel(sim, cfg, fx)
+    target = TargetModel(sim, cfg, fx)
+    host = HostModel(sim, cfg)
+
+    master.tx = Link(sim, cfg, link_stats)
+    master.host_rx = host.master.on_device_line
+    target.tx = Link(sim, cfg, link_stats)
+    target.host_rx = host.target.on_device_line
+    host.master.tx = Link(sim, cfg, link_stats)
+    host.master.device_rx = master.on_rx
+    host.target.tx = Link(sim, cfg, link_stats)
+    host.target.device_rx = target.on_rx
+    master.reset_target = target.reset
+
+    # Let both sides finish the initial handshake
+    sim.run_while(lambda: master.state != M_WAIT_BUTTON or target.handshake, 10000.0)
+
+    times: list[float] = []
+    detect_times: list[float] = []
+    res = {"pass": 0, "fail": 0, "hang": 0, "flash_fail": 0,
+           "defects": 0, "detected": 0, "missed": 0, "false_fail": 0, "recovered": 0}
+    for _ in range(cycles):
+        defect = fx.set_defect(rng, cfg.defect_rate)
+        res["defects"] += defect
+        t0 = sim.now
+        if cfg.flash:
+            dfu = _enum_ms(rng, cfg, cfg.dfu_enum_ms)
+            app = _enum_ms(rng, cfg, cfg.app_enum_ms)
+            limit = cfg.flash_timeout_s * 1000.0
+            if dfu > limit or app > limit:
+                res["flash_fail"] += 1
+                sim.run(sim.now + limit)
+                times.append(sim.now - t0)
+                continue
+            flash = rng.lognormvariate(math.log(cfg.flash_ms), 0.1)
+            sim.run(sim.now + dfu + flash + app)
+            target.reset()
+        host.verdict = None
+        if cfg.start_by_button:
+            master.press_button(rng.lognormvariate(math.log(cfg.button_hold_ms), 0.3))
+        else:
+            host.run_test()
+        deadline = sim.now + cfg.max_cycle_ms
+        sim.run(deadline)
+        dt = sim.now - t0
+        if host.watchdog and host.watchdog.run_steps and host.verdict is not None:
+            res["recovered"] += 1
+        if host.verdict is None:
+            res["hang"] += 1
+            # Operator recovery: restart the app and both boards
+            sim.clear()
+            host.reset()
+            master.reset()
+            target.reset()
+            sim.run_while(lambda: master.state != M_WAIT_BUTTON or target.handshake,
+                          sim.now + 10000.0)
+            times.append(dt)
+            continue
+        times.append(dt)
+        if host.verdict == "PASS":
+            res["pass"] += 1
+            res["missed"] += defect
+        else:
+            res["fail"] += 1
+            if defect:
+                res["detected"] += 1
+                detect_times.append(dt)
+            else:
+                res["false_fail"] += 1
+    res["dropped"] = link_stats["dropped"]
+    res["events"] = sim.events
+    return res, times, detect_times
+
+
+def _simulate_job(job):
+    return _simulate(*job)
+
+
+def run_config(cfg: SimConfig, cycles: int, seed: int = 1, jobs: int = 1) -> dict:
+    """Simulate `cycles` test cycles, split over `jobs` processes, and aggregate statistics."""
+    jobs = max(1, min(jobs, cycles))
+    parts = [(cfg, cycles // jobs + (1 if i < cycles % jobs else 0), seed + i) for i in range(jobs)]
+    wall0 = time.perf_counter()
+    if jobs == 1:
+        results = [_simulate_job(parts[0])]
+    else:
+        with multiprocessing.Pool(jobs) as pool:
+            results = pool.map(_simulate_job, parts)
+    wall = time.perf_counter() - wall0
+
+    res: dict = {}
+    times: list[float] = []
+    detect_times: list[float] = []
+    for r, t, d in results:
+        for k, v in r.items():
+            res[k] = res.get(k, 0) + v
+        times.extend(t)
+        detect_times.extend(d)
+    times.sort()
+    detect_times.sort()
+    res.update({
+        "cycles": cycles,
+        "mean_ms": statistics.fmean(times) if times else float("nan"),
+        "p50_ms": _percentile(times, 0.50),
+        "p95_ms": _percentile(times, 0.95),
+        "p99_ms": _percentile(times, 0.99),
+        "max_ms": times[-1] if times else float("nan"),
+        "detect_p50_ms": _percentile(detect_times, 0.50),
+        "cycles_per_s": cycles / wall if wall > 0 else float("inf"),
+    })
+    return res
+
+
+def _parse_assignments(items: list[str], base: SimConfig) -> SimConfig:
+    types = {f.name: f.type for f in fields(SimConfig)}
+    changes = {}
+    for item in items:
+        name, _, value = item.partition("=")
+        name = name.strip()
+        if name not in types:
+            raise SystemExit(f"Unknown parameter: {name}")
+        if types[name] in (bool, "bool"):
+            changes[name] = value.strip().lower() in ("1", "true", "yes", "on")
+        else:
+            changes[name] = float(value)
+    return replace(base, **changes)
+
+
+def _format_row(label: str, r: dict) -> str:
+    n = r["cycles"]
+    return (
+        f"{label:<28} {r['mean_ms']:>9.0f} {r['p50_ms']:>9.0f} {r['p95_ms']:>9.0f} {r['p99_ms']:>9.0f}"
+        f" {100.0 * r['pass'] / n:>6.1f}% {r['fail']:>5} {r['hang']:>5} {r['flash_fail']:>5}"
+        f" {r['detected']:>4}/{r['defects']:<4} {r['missed']:>5} {r['false_fail']:>6} {r['recovered']:>6}"
+        f" {r['cycles_per_s']:>8.0f}"
+    )
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Discrete-event simulation of the c!n tester protocol")
+    parser.add_argument("--cycles", type=int, default=1000, help="test cycles per configuration")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1,
+                        help="worker processes per configuration")
+    parser.add_argument("--set", action="append", default=[], metavar="NAME=VALUE",
+                        help="override a SimConfig parameter (repeatable)")
+    parser.add_argument("--fault", action="append", default=[], metavar="NAME=VALUE",
+                        help="inject a fault, e.g. drop_rate=0.001 (repeatable)")
+    parser.add_argument("--sweep", action="append", default=[], metavar="NAME=V1,V2,...",
+                        help="run one configuration per value (repeatable, cartesian product)")
+    args = parser.parse_args(argv)
+
+    base = _parse_assignments(args.set + args.fault, SimConfig())
+    configs = [("baseline", base)]
+    for spec in args.sweep:
+        name, _, values = spec.partition("=")
+        configs = [
+            (f"{label}, {name}={v}" if label != "baseline" else f"{name}={v}",
+             _parse_assignments([f"{name}={v}"], cfg))
+            for label, cfg in configs
+            for v in values.split(",")
+        ]
+
+    print(f"{'config':<28} {'mean ms':>9} {'p50 ms':>9} {'p95 ms':>9} {'p99 ms':>9} {'pass':>7}"
+          f" {'fail':>5} {'hang':>5} {'flash':>5} {'det/def':>9} {'miss':>5} {'f.fail':>6} {'recov':>6} {'cyc/s':>8}")
+    for label, cfg in configs:
+        print(_format_row(label, run_config(cfg, args.cycles, args.seed, args.jobs)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,245 @@
+"""Binary capture of the serial traffic of a run, and its offline replay.
+
+With the R button on the logs page checked, every run is recorded to
+`traces/run_<date>.cncap`: each line written to or read from either board,
+with its monotonic timestamp and direction. SerialReader threads only append
+to a deque; a writer thread encodes and writes in the background, so neither
+the readers nor the GUI thread touch the file.
+
+File layout (little endian):
+
+    header  b"CNCAP" version:u8 start_unix_us:u64
+    record  t_us:u32 flags:u8 length:u16 utf-8 line
+
+t_us counts from the capture start. flags: FLAG_TARGET (else Master),
+FLAG_TX (host -> board, else board -> host), FLAG_CONTEXT (a line received
+before the run, e.g. the HELLO? descriptor, stored at t_us 0).
+
+Replay (`main.py --replay <file> [--speed N]`) feeds the received lines back
+through MainWindow's line handler at N times real time (0: as fast as
+possible) and compares what the controller sends with the recorded commands.
+
+Usage:
+    python serial_capture.py traces/run_20261017_101500.cncap   # print as text
+"""
+import argparse
+import os
+import struct
+import sys
+import threading
+import time
+from collections import deque
+from dataclasses import dataclass
+
+from PySide6.QtCore import QElapsedTimer, QObject, QTimer, Signal
+
+MAGIC = b"CNCAP"
+VERSION = 1
+HEADER = struct.Struct("<5sBQ")
+RECORD = struct.Struct("<IBH")
+
+FLAG_TARGET = 1 << 0
+FLAG_TX = 1 << 1
+FLAG_CONTEXT = 1 << 2
+
+WRITE_PERIOD_S = 0.2  # writer thread wake-up period
+
+
+@dataclass
+class CaptureRecord:
+    t_us: int
+    role: str       # "master" / "target"
+    direction: str  # "tx" / "rx"
+    line: str
+    context: bool = False
+
+
+class CaptureWriter:
+    """Per-run recorder. `tap` matches the SerialReader tap and may be called from any thread."""
+
+    def __init__(self, path: str):
+        self.path = path
+        self.t0_ns = time.monotonic_ns()
+        self.records = 0
+        self._pending: deque = deque()
+        self._stop = threading.Event()
+        os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+        self._file = open(path, "wb")
+        self._file.write(HEADER.pack(MAGIC, VERSION, time.time_ns() // 1000))
+        self._thread = threading.Thread(target=self._run, name="capture-writer", daemon=True)
+        self._thread.start()
+
+    def tap(self, role: str, direction: str, line: str, t_ns: int):
+        self._pending.append((t_ns, role, direction, line, False))
+
+    def add_context(self, role: str, line: str):
+        """Record a line received before the run (replayed first, at t = 0)."""
+        self._pending.append((self.t0_ns, role, "rx", line, True))
+
+    def close(self):
+        """Stop recording; the writer thread writes what is left and closes the file."""
+        self._stop.set()
+
+    def wait_closed(self, timeout_s: float = 2.0) -> bool:
+        self._thread.join(timeout_s)
+        return not self._thread.is_alive()
+
+    def _run(self):
+        while not self._stop.wait(WRITE_PERIOD_S):
+            self._drain()
+        self._drain()
+        self._file.close()
+
+    def _drain(self):
+        chunks = []
+        pending = self._pending
+        while pending:
+            t_ns, role, direction, line, context = pending.popleft()
+            data = line.rstrip("\r\n").encode("utf-8")[:0xFFFF]
+            flags = ((FLAG_TARGET if role == "target" else 0) | (FLAG_TX if direction == "tx" else 0)
+                     | (FLAG_CONTEXT if context else 0))
+            t_us = min(max(t_ns - self.t0_ns, 0) // 1000, 0xFFFFFFFF)
+            chunks.append(RECORD.pack(t_us, flags, len(data)))
+            chunks.append(data)
+            self.records += 1
+        if chunks:
+            self._file.write(b"".join(chunks))
+            self._file.flush()
+
+
+def read_capture(path: str) -> tuple[int, list[CaptureRecord]]:
+    """Return (start_unix_us, records) of a capture file; a truncated last record is dropped."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        raise ValueError(f"{path}: not a capture file")
+    magic, version, start_us = HEADER.unpack_from(data, 0)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(f"{path}: not a version {VERSION} capture file")
+    records = []
+    off = HEADER.size
+    while off + RECORD.size <= len(data):
+        t_us, flags, length = RECORD.unpack_from(data, off)
+        off += RECORD.size
+        if off + length > len(data):
+            break
+        line = data[off:off + length].decode("utf-8", errors="replace")
+        off += length
+        records.append(CaptureRecord(t_us, "target" if flags & FLAG_TARGET else "master",
+                                     "tx" if flags & FLAG_TX else "rx", line, bool(flags & FLAG_CONTEXT)))
+    return start_us, records
+
+
+class ReplayPort:
+    """Stands in for a SerialReader during replay: keeps what the controller sends."""
+
+    def __init__(self, role: str):
+        self.role = role
+        self.tap = None
+        self.sent: list[str] = []
+
+    def send_line(self, line: str) -> bool:
+        self.sent.append(line.strip())
+        return True
+
+    def stop(self):
+        pass
+
+    def wait(self, _ms: int = 0) -> bool:
+        return True
+
+
+class CaptureReplay(QObject):
+    """Feed a capture's received lines to `window.on_serial_line` on the GUI thread.
+
+    speed is the time scale (1.0 real time, 10.0 ten times faster); 0 delivers
+    every line at once, which measures the parser/controller throughput.
+    """
+
+    finished = Signal(str)  # summary
+
+    def __init__(self, window, path: str, speed: float = 1.0):
+        super().__init__(window)
+        self.window = window
+        self.path = path
+        self.speed = speed
+        _, records = read_capture(path)
+        self.context = [r for r in records if r.context]
+        self.rx = [r for r in records if not r.context and r.direction == "rx"]
+        self.tx = {role: [r.line.strip() for r in records if r.direction == "tx" and r.role == role]
+                   for role in ("master", "target")}
+        self.ports = {"master": ReplayPort("master"), "target": ReplayPort("target")}
+        self._next = 0
+        self._clock = QElapsedTimer()
+        self._handler_ns = 0
+        window.attach_replay_ports(self.ports["master"], self.ports["target"])
+
+    def start(self):
+        for r in self.context:
+            self.window.on_serial_line(r.role, r.line)
+        for port in self.ports.values():
+            port.sent.clear()  # compare the run's commands only
+        self.window.on_run_test()  # every capture starts with a run
+        self._clock.start()
+        if self.speed <= 0:
+            self._deliver(len(self.rx))
+            self._finish()
+        else:
+            self._tick()
+
+    def _deliver(self, end: int):
+        on_line = self.window.on_serial_line
+        t0 = time.perf_counter_ns()
+        while self._next < end:
+            r = self.rx[self._next]
+            on_line(r.role, r.line)
+            self._next += 1
+        self._handler_ns += time.perf_counter_ns() - t0
+
+    def _tick(self):
+        elapsed_us = self._clock.nsecsElapsed() / 1000.0 * self.speed
+        end = self._next
+        while end < len(self.rx) and self.rx[end].t_us <= elapsed_us:
+            end += 1
+        self._deliver(end)
+        if self._next >= len(self.rx):
+            self._finish()
+            return
+        wait_ms = (self.rx[self._next].t_us - elapsed_us) / 1000.0 / self.speed
+        QTimer.singleShot(max(0, int(wait_ms)), self._tick)
+
+    def _finish(self):
+        wall_s = self._clock.nsecsElapsed() / 1e9
+        span_s = (self.rx[-1].t_us / 1e6) if self.rx else 0.0
+        handler_s = self._handler_ns / 1e9
+        diverged = []
+        for role, recorded in self.tx.items():
+            sent = self.ports[role].sent
+            for i in range(max(len(sent), len(recorded))):
+                got = sent[i] if i < len(sent) else "-"
+                want = recorded[i] if i < len(recorded) else "-"
+                if got != want:
+                    diverged.append(f"{role} #{i + 1} sent '{got}', captured '{want}'")
+                    break
+        rate = len(self.rx) / handler_s if handler_s > 0 else 0.0
+        summary = (f"Replay: {len(self.rx)} lines of {os.path.basename(self.path)} in {wall_s:.3f} s "
+                   f"({span_s / wall_s if wall_s > 0 else 0:.0f}x real time), handler {rate:.0f} lines/s; "
+                   + ("commands match the capture" if not diverged else "commands differ: " + "; ".join(diverged)))
+        self.finished.emit(summary)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Print a serial traffic capture as text")
+    parser.add_argument("capture", help=".cncap file")
+    args = parser.parse_args(argv)
+    start_us, records = read_capture(args.capture)
+    print(f"# {args.capture}: {len(records)} lines, started "
+          f"{time.strftime('%Y-%m-%d %H:%M:%S', time.localtime(start_us / 1e6))}")
+    for r in records:
+        mark = "ctx" if r.context else r.direction
+        print(f"{r.t_us / 1000.0:10.3f} ms  {r.role:<6} {mark:<3} {r.line}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
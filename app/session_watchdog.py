@@ -0,0 +1,177 @@
+"""Host-side session watchdog: stage deadlines and escalating recovery.
+
+A run is a conversation: the app sends a stage command and waits for the
+boards to answer. A lost line, or a board that re-enumerates mid-run, used
+to leave the GUI in the testing state until the operator restarted it.
+SessionWatchdog knows the stage the run waits in and when the session last
+made progress (a new line from either board). Once a stage's deadline
+passes without progress, poll() returns the next recovery step:
+
+    resend        re-send the commands sent since the last progress
+    reinit        INIT both boards; the Master abandons its run (RUN ABORTED)
+                  and the app starts it again once both are READY
+    reset_target  the Master pulses the Target's reset (RESET_TARGET), then INIT
+    restart_port  close and reopen both serial ports, then INIT
+    give_up       end the run as an error; the operator takes over
+
+Steps that cannot help are skipped: resend without pending commands, and
+reset_target on a Master without the recovery feature. The ladder starts
+over once the session gets past the point where it stalled; stages re-run
+after a reinit do not count until they get further than before.
+
+A repeated line (the Master's AWAIT_PIN reprint, heartbeats, hello beacons)
+is not progress. The clock is passed in, so the protocol simulator drives
+the same watchdog on its virtual time.
+"""
+import threading
+from collections import Counter
+
+STEPS = ("resend", "reinit", "reset_target", "restart_port")
+GIVE_UP = "give_up"
+
+# Stage -> seconds without progress before a recovery step. Each check answers
+# within milliseconds; the margins cover USB latency, the ID? query before
+# START (1 s) and the Master's own 1 s pin timeout.
+DEADLINES_S = {
+    "start": 6.0,     # INIT -> READY -> ID? -> START
+    "all_high": 2.0,
+    "all_low": 2.0,
+    "xtalk": 3.0,     # per aggressor (5 ms window)
+    "clock": 3.0,     # per clock (~100 ms gate)
+    "vcc": 2.0,       # ~100 ms script
+    "sequence": 3.0,  # per pin
+}
+STAGE_ALIASES = {"pin": "sequence"}  # MainWindow's per-pin latency stage
+
+# After reset_target or restart_port the boards re-enumerate before they talk
+RECOVERY_GRACE_S = 8.0
+
+
+class SessionWatchdog:
+    """Deadline and recovery ladder of one run; heard()/sent() may come from any thread."""
+
+    def __init__(self, deadlines: dict[str, float] | None = None):
+        self.deadlines = dict(deadlines or DEADLINES_S)
+        self.counts: Counter = Counter()  # recovery steps taken since start-up
+        self.run_steps: list[str] = []    # steps taken in the current run
+        self._lock = threading.Lock()
+        self._armed = False
+        self._reset_target = False
+        self._stage = "start"
+        self._lines = 0
+        self._last: dict[str, str] = {}
+        self._pending: dict[tuple[str, str], None] = {}  # ordered set of (role, line)
+        self._progress_t = 0.0
+        self._wait_s = 0.0
+        self._level = 0
+        self._best = (0, 0)     # furthest (stage, lines) of this run
+        self._stalled = (-1, 0)  # where the last recovery happened
+
+    @property
+    def armed(self) -> bool:
+        return self._armed
+
+    @property
+    def current_stage(self) -> str:
+        return self._stage
+
+    def arm(self, now: float, reset_target: bool = False):
+        """A run starts: wait for START. reset_target: the Master accepts RESET_TARGET."""
+        with self._lock:
+            self._armed = True
+            self._reset_target = reset_target
+            self._level = 0
+            self._best = (0, 0)
+            self._stalled = (-1, 0)
+            self.run_steps = []
+            self._enter("start", now)
+
+    def disarm(self):
+        with self._lock:
+            self._armed = False
+            self._pending.clear()
+
+    def stage(self, name: str, now: float):
+        """The run waits in a new stage (or for the next pin/aggressor of one)."""
+        name = STAGE_ALIASES.get(name, name)
+        if name not in self.deadlines:
+            return
+        with self._lock:
+            if name != self._stage:
+                self._enter(name, now)
+            self._advance(now)
+
+    def restart(self, now: float):
+        """The app re-INITs the boards: the run starts over from START."""
+        with self._lock:
+            self._pending.clear()
+            self._enter("start", now)
+
+    def heard(self, role: str, line: str, now: float):
+        with self._lock:
+            if self._last.get(role) == line:
+                return
+            self._last[role] = line
+            self._pending.clear()
+            self._advance(now)
+
+    def sent(self, role: str, line: str):
+        line = line.strip()
+        if not line:
+            return
+        with self._lock:
+            if self._armed:
+                self._pending[(role, line)] = None
+
+    def pending(self) -> list[tuple[str, str]]:
+        with self._lock:
+            return list(self._pending)
+
+    def poll(self, now: float) -> str | None:
+        """The recovery step due now, or None. Each step gets the stage's deadline to work."""
+        with self._lock:
+            if not self._armed or now - self._progress_t < self._wait_s:
+                return None
+            step = GIVE_UP
+            while self._level < len(STEPS):
+                candidate = STEPS[self._level]
+                self._level += 1
+                if candidate == "resend" and not self._pending:
+                    continue
+                if candidate == "reset_target" and not self._reset_target:
+                    continue
+                step = candidate
+                break
+            self._stalled = max(self._best, self._position())
+            self._progress_t = now
+            self._wait_s = self.deadlines[self._stage]
+            if step in ("reset_target", "restart_port"):
+                self._wait_s = max(self._wait_s, RECOVERY_GRACE_S)
+            if step == GIVE_UP:
+                self._armed = False
+            else:
+                self.counts[step] += 1
+            self.run_steps.append(step)
+            return step
+
+    def summary(self) -> str:
+        return ", ".join(f"{step} {n}" for step, n in self.counts.items()) or "none"
+
+    # --- internal, called with the lock held ---
+    def _position(self) -> tuple[int, int]:
+        return (list(self.deadlines).index(self._stage), self._lines)
+
+    def _enter(self, name: str, now: float):
+        self._stage = name
+        self._lines = 0
+        self._progress_t = now
+        self._wait_s = self.deadlines[name]
+
+    def _advance(self, now: float):
+        self._lines += 1
+        self._progress_t = now
+        self._wait_s = self.deadlines[self._stage]
+        position = self._position()
+        self._best = max(self._best, position)
+        if position > self._stalled:
+            self._level = 0
@@ -0,0 +1,176 @@
+"""Statistical process control of per-pin timing and failure rates.
+
+A run's verdict is pass/fail, but a fixture wears out slowly: pogo pins lose
+force, contacts oxidise, settle times creep up long before a pin reads wrong.
+SpcTracker keeps, per station and per pin, three EWMA control charts that
+are updated in O(1) per run:
+
+    latency_s  host time from AWAIT_PIN to the Master's SEQUENCE OK line
+    settle_us  Master time from NEXT_PIN to the pin read HIGH (settle_us=)
+    fail       1 when the pin is in the run's defect map, else 0
+
+The first WARMUP samples of a chart fix its baseline mean and standard
+deviation (Welford; floored at the measurement resolution, and at
+sqrt(p (1 - p)) for the failure rate). After that the chart tracks the EWMA
+statistic z = lam * x + (1 - lam) * z and raises an alarm when z crosses the
+upper control limit mean + L_SIGMA * sigma * sqrt(lam / (2 - lam)): the
+drift is flagged while single runs still pass. An EWMA mean and variance of
+the recent samples are kept next to it for display.
+
+The state is a small JSON file per station in the traces directory, so the
+baseline survives restarts. After fixture maintenance, reset it:
+
+    python spc.py traces/spc_<station>.json                 # print the charts
+    python spc.py traces/spc_<station>.json --reset P0_06   # new baseline for a pin
+    python spc.py traces/spc_<station>.json --reset all
+"""
+import argparse
+import json
+import math
+import os
+import sys
+
+L_SIGMA = 3.0      # control limit width in EWMA standard deviations
+WARMUP = 20        # samples that set the baseline
+MIN_FAIL_P = 0.01  # floor for a failure-rate baseline measured as 0
+
+# stat -> (EWMA weight of the newest sample, sigma floor or None for a 0/1 rate).
+# The failure rate uses a slow EWMA so that a single failure stays below the limit.
+CHARTS = {
+    "latency_s": (0.2, 0.005),  # GUI timer and USB jitter
+    "settle_us": (0.2, 250.0),  # Master polls the pin every millisecond
+    "fail": (0.05, None),
+}
+STATS = tuple(CHARTS)
+
+
+class EwmaChart:
+    """One-sided (upper) EWMA control chart with a warm-up baseline."""
+
+    __slots__ = ("lam", "floor", "n", "base_mean", "base_m2", "z", "mean", "var", "alarm")
+
+    def __init__(self, stat: str):
+        self.lam, self.floor = CHARTS[stat]
+        self.n = 0
+        self.base_mean = 0.0
+        self.base_m2 = 0.0
+        self.z = 0.0
+        self.mean = 0.0
+        self.var = 0.0
+        self.alarm = False
+
+    def center(self) -> float:
+        return max(self.base_mean, MIN_FAIL_P) if self.floor is None else self.base_mean
+
+    def baseline_sigma(self) -> float:
+        if self.floor is None:
+            p = self.center()
+            return math.sqrt(p * (1.0 - p))
+        count = min(self.n, WARMUP)
+        sigma = math.sqrt(self.base_m2 / (count - 1)) if count > 1 else 0.0
+        return max(sigma, self.floor)
+
+    def ucl(self) -> float:
+        return self.center() + L_SIGMA * self.baseline_sigma() * math.sqrt(self.lam / (2.0 - self.lam))
+
+    def update(self, x: float) -> bool:
+        """Add a sample; return True when the chart has just gone out of control."""
+        self.n += 1
+        if self.n == 1:
+            self.mean = x
+        d = x - self.mean
+        self.mean += self.lam * d
+        self.var = (1.0 - self.lam) * (self.var + self.lam * d * d)
+        if self.n <= WARMUP:
+            # Welford on the baseline samples
+            delta = x - self.base_mean
+            self.base_mean += delta / self.n
+            self.base_m2 += delta * (x - self.base_mean)
+            self.z = self.base_mean
+            return False
+        self.z = self.lam * x + (1.0 - self.lam) * self.z
+        was = self.alarm
+        self.alarm = self.z > self.ucl()
+        return self.alarm and not was
+
+    def to_list(self) -> list:
+        return [self.n, self.base_mean, self.base_m2, self.z, self.mean, self.var, self.alarm]
+
+    @classmethod
+    def from_list(cls, stat: str, values: list) -> "EwmaChart":
+        chart = cls(stat)
+        chart.n, chart.base_mean, chart.base_m2, chart.z, chart.mean, chart.var, chart.alarm = values
+        return chart
+
+
+class SpcTracker:
+    """Per-pin charts of one station, persisted to `path`."""
+
+    def __init__(self, path: str):
+        self.path = path
+        self.charts: dict[str, dict[str, EwmaChart]] = {}  # pin -> stat -> chart
+        try:
+            with open(path, "r", encoding="utf-8") as f:
+                data = json.load(f)
+            for pin, stats in data.get("pins", {}).items():
+                self.charts[pin] = {stat: EwmaChart.from_list(stat, v) for stat, v in stats.items() if stat in STATS}
+        except (OSError, ValueError, TypeError):
+            pass
+
+    def observe(self, pin: str, stat: str, x: float) -> str | None:
+        """Add one sample; return an alarm message when the pin drifts out of control."""
+        stats = self.charts.setdefault(pin, {})
+        chart = stats.get(stat)
+        if chart is None:
+            chart = stats[stat] = EwmaChart(stat)
+        if not chart.update(float(x)):
+            return None
+        return (f"SPC: {pin} {stat} drifting — EWMA {chart.z:.4g} above UCL {chart.ucl():.4g} "
+                f"(baseline {chart.center():.4g} ± {chart.baseline_sigma():.3g}, {chart.n} runs)")
+
+    def out_of_control(self) -> list[tuple[str, str]]:
+        return sorted((pin, stat) for pin, stats in self.charts.items() for stat, c in stats.items() if c.alarm)
+
+    def reset(self, pin: str | None = None):
+        """Forget the baseline of one pin, or of all pins when pin is None."""
+        if pin is None:
+            self.charts.clear()
+        else:
+            self.charts.pop(pin, None)
+
+    def save(self):
+        data = {"l_sigma": L_SIGMA, "warmup": WARMUP,
+                "pins": {pin: {stat: c.to_list() for stat, c in stats.items()}
+                         for pin, stats in self.charts.items()}}
+        os.makedirs(os.path.dirname(self.path) or ".", exist_ok=True)
+        tmp = self.path + ".tmp"
+        with open(tmp, "w", encoding="utf-8") as f:
+            json.dump(data, f)
+        os.replace(tmp, self.path)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Print or reset the SPC charts of a station")
+    parser.add_argument("state", help="spc_<station>.json")
+    parser.add_argument("--reset", metavar="PIN", help="pin label, or 'all'")
+    args = parser.parse_args(argv)
+    tracker = SpcTracker(args.state)
+    if args.reset:
+        tracker.reset(None if args.reset.lower() == "all" else args.reset)
+        tracker.save()
+        print(f"reset {args.reset}")
+        return 0
+    print(f"{'pin':<12} {'stat':<10} {'runs':>5} {'baseline':>10} {'ucl':>10} {'ewma':>10} {'ewm_sd':>10}")
+    for pin in sorted(tracker.charts):
+        for stat in STATS:
+            c = tracker.charts[pin].get(stat)
+            if c is None:
+                continue
+            ucl = f"{c.ucl():10.4g}" if c.n > WARMUP else f"{'warm-up':>10}"
+            print(f"{pin:<12} {stat:<10} {c.n:5d} {c.base_mean:10.4g} {ucl} {c.z:10.4g} "
+                  f"{math.sqrt(c.var):10.4g}{'  ALARM' if c.alarm else ''}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,85 @@
+"""Startup phase timing.
+
+main.py imports this module first and marks each phase (Qt import, UI
+import, window construction, first paint, background port scan). The summary
+goes to the log panes, so a slow start shows where the time went:
+
+    Startup: launch 310 ms, qt 160 ms, ui 45 ms, window 27 ms, shown 12 ms = 554 ms to window; ports 35 ms
+
+`launch` is the time before Python ran this module: interpreter start and,
+for a Nuitka onefile build, unpacking the payload (the onefile bootstrap
+process is found through NUITKA_ONEFILE_PARENT). It is omitted where the
+process start time is not available.
+"""
+import os
+import sys
+import time
+
+
+def _process_start_epoch(pid: int) -> float | None:
+    """Wall-clock start time of a process, or None when unsupported."""
+    try:
+        if sys.platform.startswith("linux"):
+            with open(f"/proc/{pid}/stat", "rb") as f:
+                fields = f.read().rsplit(b")", 1)[1].split()
+            start_ticks = int(fields[19])  # field 22: starttime, clock ticks since boot
+            with open("/proc/uptime", "rb") as f:
+                uptime = float(f.read().split()[0])
+            return time.time() - uptime + start_ticks / os.sysconf("SC_CLK_TCK")
+        if os.name == "nt":
+            import ctypes
+            from ctypes import wintypes
+
+            kernel32 = ctypes.windll.kernel32
+            handle = kernel32.OpenProcess(0x1000, False, pid)  # PROCESS_QUERY_LIMITED_INFORMATION
+            if not handle:
+                return None
+            try:
+                times = [wintypes.FILETIME() for _ in range(4)]
+                if not kernel32.GetProcessTimes(handle, *[ctypes.byref(t) for t in times]):
+                    return None
+                created = (times[0].dwHighDateTime << 32) | times[0].dwLowDateTime
+                return created / 1e7 - 11644473600.0  # FILETIME epoch 1601 -> Unix epoch
+            finally:
+                kernel32.CloseHandle(handle)
+    except Exception:
+        return None
+    return None
+
+
+class StartupTimer:
+    def __init__(self):
+        self.t0 = time.perf_counter()
+        self.phases: list[tuple[str, float]] = []
+        self._last = self.t0
+        self.launch_s: float | None = None
+        pid = int(os.environ.get("NUITKA_ONEFILE_PARENT") or os.getpid())
+        started = _process_start_epoch(pid)
+        if started is not None:
+            self.launch_s = max(0.0, time.time() - started)
+
+    def mark(self, phase: str):
+        """End `phase` now; its duration is the time since the previous mark."""
+        now = time.perf_counter()
+        self.phases.append((phase, now - self._last))
+        self._last = now
+
+    def mark_background(self, phase: str, duration_s: float):
+        """Record work that ran off the GUI thread (not on the path to the window)."""
+        self.phases.append((phase + "*", duration_s))
+
+    def to_window_s(self) -> float:
+        fg = sum(d for name, d in self.phases if not name.endswith("*"))
+        return fg + (self.launch_s or 0.0)
+
+    def summary(self) -> str:
+        parts = []
+        if self.launch_s is not None:
+            parts.append(f"launch {self.launch_s * 1000:.0f} ms")
+        parts += [f"{name} {d * 1000:.0f} ms" for name, d in self.phases if not name.endswith("*")]
+        text = f"Startup: {', '.join(parts)} = {self.to_window_s() * 1000:.0f} ms to window"
+        bg = [f"{name[:-1]} {d * 1000:.0f} ms" for name, d in self.phases if name.endswith("*")]
+        return text + (f"; {', '.join(bg)}" if bg else "")
+
+
+TIMER = StartupTimer()
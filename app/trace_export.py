@@ -0,0 +1,153 @@
+"""Per-run timeline trace merging host, Master and Target events.
+
+Device timestamps (`micros()`) are aligned with the host monotonic clock via
+the TIMESYNC exchange: the host notes when a `TIMESYNC` line was written and
+when the `<Role>: TIMESYNC <us>` reply arrived, and assumes the device sampled
+its clock half-way. The sample with the smallest round trip wins; with samples
+from both ends of the run a linear fit also removes crystal drift.
+
+The result is written as a Chrome trace JSON, which Perfetto
+(https://ui.perfetto.dev) and chrome://tracing open directly.
+"""
+import json
+import os
+import sys
+import threading
+import time
+from collections import deque
+
+PROCESSES = {"host": 1, "master": 2, "target": 3}
+
+
+def traces_dir() -> str:
+    """Directory for per-run artifacts, next to the executable like app_error.log."""
+    return os.path.join(os.path.dirname(os.path.abspath(sys.argv[0])), "traces")
+
+
+class RunTrace:
+    """Thread-safe event collector for one test run."""
+
+    def __init__(self):
+        self.t0_ns = time.monotonic_ns()
+        self._lock = threading.Lock()
+        self._events: list[dict] = []
+        self._sync_pending: dict[str, deque] = {"master": deque(), "target": deque()}
+        # role -> list of (rtt_ns, device_us, host_mid_ns) per sync burst
+        self._sync_bursts: dict[str, list[list[tuple[int, int, int]]]] = {"master": [], "target": []}
+        self._last_us: dict[str, int] = {}
+        self._wraps: dict[str, int] = {}
+
+    # --- Host side ---
+    def _ts(self, t_ns: int) -> float:
+        return (t_ns - self.t0_ns) / 1000.0
+
+    def host_instant(self, name: str, tid: str = "ui", args: dict | None = None, t_ns: int | None = None):
+        ev = {"name": name, "ph": "i", "s": "t", "pid": PROCESSES["host"], "tid": tid,
+              "ts": self._ts(t_ns if t_ns is not None else time.monotonic_ns())}
+        if args:
+            ev["args"] = args
+        with self._lock:
+            self._events.append(ev)
+
+    def host_span(self, name: str, start_ns: int, end_ns: int, tid: str = "ui", args: dict | None = None):
+        ev = {"name": name, "ph": "X", "pid": PROCESSES["host"], "tid": tid,
+              "ts": self._ts(start_ns), "dur": (end_ns - start_ns) / 1000.0}
+        if args:
+            ev["args"] = args
+        with self._lock:
+            self._events.append(ev)
+
+    def on_serial_traffic(self, role: str, direction: str, line: str, t_ns: int):
+        """Tap for SerialReader: called from the reader thread on every write/read."""
+        if direction == "tx":
+            if line.strip().upper() == "TIMESYNC":
+                with self._lock:
+                    self._sync_pending[role].append(t_ns)
+            self.host_instant(f"write {line.strip()}", tid=f"{role} port", t_ns=t_ns)
+        else:
+            # "<Role>: TIMESYNC <us>" and "<Role>: TRACE <us> <B|E|I> <name> [arg]"
+            parts = line.split()
+            try:
+                if len(parts) == 3 and parts[1] == "TIMESYNC":
+                    self.on_timesync_reply(role, int(parts[2]), t_ns)
+                    return
+                if len(parts) >= 5 and parts[1] == "TRACE":
+                    arg = " ".join(parts[5:]) or None
+                    self.on_device_trace(role, int(parts[2]), parts[3], parts[4], arg)
+                    return
+            except ValueError:
+                pass
+            self.host_instant("line received", tid=f"{role} port", args={"line": line}, t_ns=t_ns)
+
+    # --- Device side ---
+    def begin_sync_burst(self):
+        with self._lock:
+            for bursts in self._sync_bursts.values():
+                bursts.append([])
+
+    def on_timesync_reply(self, role: str, device_us: int, t_recv_ns: int):
+        with self._lock:
+            pending = self._sync_pending.get(role)
+            if not pending or not self._sync_bursts[role]:
+                return
+            t_send_ns = pending.popleft()
+            self._sync_bursts[role][-1].append(
+                (t_recv_ns - t_send_ns, self._unwrap(role, device_us), (t_send_ns + t_recv_ns) // 2))
+
+    def on_device_trace(self, role: str, device_us: int, phase: str, name: str, arg: str | None):
+        """Record a `<Role>: TRACE <us> <B|E|I> <name> [arg]` event in device time."""
+        ph = {"B": "B", "E": "E"}.get(phase.upper(), "i")
+        ev = {"name": name, "ph": ph, "pid": PROCESSES[role], "tid": "firmware"}
+        if ph == "i":
+            ev["s"] = "t"
+        if arg:
+            ev["args"] = {"arg": arg}
+        with self._lock:
+            ev["device_us"] = self._unwrap(role, device_us)
+            self._events.append(ev)
+
+    def _unwrap(self, role: str, us: int) -> int:
+        # micros() wraps every ~71.6 minutes
+        last = self._last_us.get(role)
+        if last is not None and us < last and last - us > (1 << 31):
+            self._wraps[role] = self._wraps.get(role, 0) + 1
+        self._last_us[role] = us
+        return us + (self._wraps.get(role, 0) << 32)
+
+    def _clock_map(self, role: str):
+        """Return f(device_us) -> host ns from the best sample of each sync burst."""
+        best = [min(b) for b in self._sync_bursts[role] if b]
+        if not best:
+            return None
+        _, d0, h0 = best[0]
+        if len(best) > 1 and best[-1][1] != d0:
+            _, d1, h1 = best[-1]
+            rate = (h1 - h0) / ((d1 - d0) * 1000.0)
+        else:
+            rate = 1.0
+        return lambda us: h0 + (us - d0) * 1000.0 * rate
+
+    def sync_complete(self) -> bool:
+        with self._lock:
+            return not any(self._sync_pending.values())
+
+    # --- Export ---
+    def write_chrome_json(self, path: str) -> str:
+        with self._lock:
+            maps = {role: self._clock_map(role) for role in ("master", "target")}
+            events = []
+            for ev in self._events:
+                if "device_us" in ev:
+                    ev = dict(ev)
+                    role = "master" if ev["pid"] == PROCESSES["master"] else "target"
+                    us = ev.pop("device_us")
+                    if maps[role] is None:
+                        continue  # no TIMESYNC reply: cannot place device events
+                    ev["ts"] = self._ts(maps[role](us))
+                events.append(ev)
+        for role, pid in PROCESSES.items():
+            events.append({"name": "process_name", "ph": "M", "pid": pid, "args": {"name": role.capitalize()}})
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "w", encoding="utf-8") as f:
+            json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, f)
+        return path
@@ -1,4 +1,5 @@
 import os
+import platform
 import re
 import threading
 import time
@@ -23,7 +24,8 @@ from PySide6.QtWidgets import (
     QComboBox,
     QGroupBox,
     QSizePolicy,
-    QPlainTextEdit, )
+    QPlainTextEdit,
+    QCheckBox, )
 
 # Flexible import of helper functions for COM ports
 # Ensures this module loads both as part of the 'app' package
@@ -35,6 +37,9 @@ try:
         send_command_to_port_item,
         parse_device_from_item,
         discover_mcu_ports,
+        port_items,
+        is_tester_port,
+        SCANNING_ITEM,
     )
 except Exception:
     try:
@@ -44,6 +49,9 @@ except Exception:
             send_command_to_port_item,
             parse_device_from_item,
             discover_mcu_ports,
+            port_items,
+            is_tester_port,
+            SCANNING_ITEM,
         )
     except Exception:
         from com_ports import (
@@ -52,35 +60,137 @@ except Exception:
             send_command_to_port_item,
             parse_device_from_item,
             discover_mcu_ports,
+            port_items,
+            is_tester_port,
+            SCANNING_ITEM,
         )
 
+try:
+    from .startup import StartupTimer
+except Exception:
+    try:
+        from app.startup import StartupTimer
+    except Exception:
+        from startup import StartupTimer
+
+try:
+    from .trace_export import RunTrace, traces_dir
+except Exception:
+    try:
+        from app.trace_export import RunTrace, traces_dir
+    except Exception:
+        from trace_export import RunTrace, traces_dir
+
+try:
+    from .serial_capture import CaptureWriter
+except Exception:
+    try:
+        from app.serial_capture import CaptureWriter
+    except Exception:
+        from serial_capture import CaptureWriter
+
+try:
+    from .spc import SpcTracker
+except Exception:
+    try:
+        from app.spc import SpcTracker
+    except Exception:
+        from spc import SpcTracker
 
-PIN_ROWS = [
-    ("GND", "B+"),
-    ("D1  P0.06", "B+"),
-    ("D0  P0.08", "GND"),
-    ("GND", "RESET"),
-    ("GND", "VCC"),
-    ("D2  P0.17", "P0.31 D21"),
-    ("D3  P0.20", "P0.29 D20"),
-    ("D4  P0.22", "P0.02 D19"),
-    ("D5  P0.24", "P1.15 D18"),
-    ("D6  P1.00", "P1.13 D15"),
-    ("D7  P0.11", "P1.11 D14"),
-    ("D8  P1.04", "P0.10 D16"),
-    ("D9  P1.06", "P0.09 D10"),
-]
+try:
+    from .golden import LEARN_RUNS, GoldenSignature, describe, flatten
+except Exception:
+    try:
+        from app.golden import LEARN_RUNS, GoldenSignature, describe, flatten
+    except Exception:
+        from golden import LEARN_RUNS, GoldenSignature, describe, flatten
+
+try:
+    from .board_history import BoardHistory, BoardIdentity, describe_runs, parse_identity
+except Exception:
+    try:
+        from app.board_history import BoardHistory, BoardIdentity, describe_runs, parse_identity
+    except Exception:
+        from board_history import BoardHistory, BoardIdentity, describe_runs, parse_identity
+
+try:
+    from . import metrics
+except Exception:
+    try:
+        from app import metrics
+    except Exception:
+        import metrics
+
+try:
+    from .descriptor import FEAT_AUTOSTART, FEAT_CLOCK, FEAT_ID, FEAT_MODES, FEAT_MONITOR, FEAT_PIN_ACK, FEAT_PIN_MASK, FEAT_RECOVERY, FEAT_VCC, FEAT_XTALK, Descriptor, expected_pin_hash, parse_desc
+except Exception:
+    try:
+        from app.descriptor import FEAT_AUTOSTART, FEAT_CLOCK, FEAT_ID, FEAT_MODES, FEAT_MONITOR, FEAT_PIN_ACK, FEAT_PIN_MASK, FEAT_RECOVERY, FEAT_VCC, FEAT_XTALK, Descriptor, expected_pin_hash, parse_desc
+    except Exception:
+        from descriptor import FEAT_AUTOSTART, FEAT_CLOCK, FEAT_ID, FEAT_MODES, FEAT_MONITOR, FEAT_PIN_ACK, FEAT_PIN_MASK, FEAT_RECOVERY, FEAT_VCC, FEAT_XTALK, Descriptor, expected_pin_hash, parse_desc
+
+
+try:
+    from .session_watchdog import GIVE_UP, SessionWatchdog
+except Exception:
+    try:
+        from app.session_watchdog import GIVE_UP, SessionWatchdog
+    except Exception:
+        from session_watchdog import GIVE_UP, SessionWatchdog
+
+try:
+    from .journal import JournalCollector, write_csv
+except Exception:
+    try:
+        from app.journal import JournalCollector, write_csv
+    except Exception:
+        from journal import JournalCollector, write_csv
+
+try:
+    from .board_profiles import DEFAULT_PROFILE, PROFILES, pin_id, pin_mask, with_neighbours
+except Exception:
+    try:
+        from app.board_profiles import DEFAULT_PROFILE, PROFILES, pin_id, pin_mask, with_neighbours
+    except Exception:
+        from board_profiles import DEFAULT_PROFILE, PROFILES, pin_id, pin_mask, with_neighbours
 
 
 class PinoutView(QGraphicsView):
+    """Board pinout with one circle per pad.
+
+    Test circles are indexed once when drawn: each keeps the pin IDs of its
+    label (P0_13 ...) and its current state. A state change compares the new
+    state of every circle with the current one and touches only the circles
+    that differ, with brushes and pens built once per palette. Pins excluded
+    from the run (set_not_tested) keep the NOT_TESTED state whatever the run
+    shows.
+    """
     log_square_clicked = Signal()
+    pin_clicked = Signal(str)  # pin ID of a clicked test circle
+
+    # Circle states
+    IDLE, TESTING, OK, FAIL, NOT_TESTED = "idle", "testing", "ok", "fail", "not_tested"
+
     def __init__(self, parent=None):
         super().__init__(parent)
         self.setScene(QGraphicsScene(self))
         self.setRenderHints(self.renderHints() | QPainter.RenderHint.Antialiasing)
         self.left_circles = []  # list of tuples (item, text)
         self.right_circles = [] # list of tuples (item, text)
+        self._test_circles: list[tuple[QGraphicsEllipseItem, tuple[str, ...]]] = []  # (item, pin IDs)
+        self._pin_circles: dict[str, list[int]] = {}  # pin ID -> indexes into _test_circles
+        self._circle_state: list[str | None] = []  # current state per test circle
+        self._styles: dict[str, tuple[QBrush, QPen | None]] = {}
+        self._not_tested: frozenset[str] = frozenset()
         self.usb_square = None
+        self._rows = DEFAULT_PROFILE.pin_rows
+        self._draw_pinout()
+
+    def set_rows(self, rows):
+        """Redraw for another board profile's pinout (rows of (left, right) text)."""
+        if tuple(rows) == tuple(self._rows):
+            return
+        self._rows = tuple(rows)
         self._draw_pinout()
 
     def _draw_pin_row(self, y, left_text, right_text, rect_left, rect_width):
@@ -107,8 +217,10 @@ class PinoutView(QGraphicsView):
         else:
             circle_item.setBrush(QBrush(btn_color))
         circle_item.setPen(QPen(alt_base_color))
-        scene.addItem(circle_item)
-        self.left_circles.append((circle_item, left_text))
+        if left_text:
+            scene.addItem(circle_item)
+            self.left_circles.append((circle_item, left_text))
+            self._index_circle(circle_item, left_text)
 
         left_label_x = left_circle_x + circle_radius + label_gap
         left_label = QGraphicsSimpleTextItem(left_text)
@@ -140,16 +252,25 @@ class PinoutView(QGraphicsView):
         else:
             right_circle_item.setBrush(QBrush(btn_color))
         right_circle_item.setPen(QPen(alt_base_color))
-        scene.addItem(right_circle_item)
-        self.right_circles.append((right_circle_item, right_text))
+        if right_text:
+            scene.addItem(right_circle_item)
+            self.right_circles.append((right_circle_item, right_text))
+            self._index_circle(right_circle_item, right_text)
 
     def _draw_pinout(self):
         scene = self.scene()
         scene.clear()
-
-        # Base rectangle (light gray)
+        self.left_circles = []
+        self.right_circles = []
+        self._test_circles = []
+        self._pin_circles = {}
+        self._circle_state = []
+        self._build_styles()
+
+        # Base rectangle (light gray); profiles with extra pad rows grow it
+        row_height = 31
         rect_width = 290
-        rect_height = 400
+        rect_height = max(400, 15 + (len(self._rows) - 1) * row_height + 13)
         rect_left = 5
         rect_top = 5
         base_rect = QGraphicsRectItem(rect_left, rect_top, rect_width, rect_height)
@@ -162,7 +283,6 @@ class PinoutView(QGraphicsView):
         scene.addItem(base_rect)
 
         # Dark square at the top center, top edge aligned with rectangle's top, descending ~3 rows
-        row_height = 31
         usb_square_size = row_height * 2.7
         usb_square_left = rect_left + (rect_width - usb_square_size) / 2
         self.usb_square = QGraphicsRectItem(usb_square_left, rect_top, usb_square_size, usb_square_size)
@@ -172,13 +292,13 @@ class PinoutView(QGraphicsView):
 
         # Draw pin rows inside the base rectangle
         start_y = rect_top  + 15
-        for i, (left_text, right_text) in enumerate(PIN_ROWS):
+        for i, (left_text, right_text) in enumerate(self._rows):
             y = start_y + i * row_height
             self._draw_pin_row(y, left_text, right_text, rect_left + 10, rect_width - 20)
 
         # Fit the view
         scene.setSceneRect(0, 0, rect_left + rect_width + 5, rect_top + rect_height + 5)
-        self.setFixedSize(305, 415)
+        self.setFixedSize(305, int(rect_height) + 15)
 
     # Helpers for coloring circles
     @staticmethod
@@ -191,53 +311,95 @@ class PinoutView(QGraphicsView):
     def _is_test_circle(self, text: str) -> bool:
         return not any(x in text for x in ("GND", "B+"))
 
+    def _index_circle(self, item: QGraphicsEllipseItem, text: str):
+        if not self._is_test_circle(text):
+            return
+        pins = tuple(self._canonical_pins_from_text(text))
+        for pin in pins:
+            self._pin_circles.setdefault(pin, []).append(len(self._test_circles))
+        self._test_circles.append((item, pins))
+        self._circle_state.append(None)
+
+    def _build_styles(self):
+        palette = QApplication.palette()
+        self._styles = {
+            self.IDLE: (QBrush(palette.color(QPalette.AlternateBase)), QPen(palette.color(QPalette.ToolTipText))),
+            self.TESTING: (QBrush(palette.color(QPalette.Highlight)), None),
+            self.OK: (QBrush(QColor(0, 200, 0)), None),  # green
+            self.FAIL: (QBrush(QColor(255, 0, 0)), None),  # red
+            self.NOT_TESTED: (QBrush(palette.color(QPalette.Mid), Qt.BrushStyle.BDiagPattern), None),  # hatched
+        }
+
+    def _set_circle(self, index: int, state: str):
+        if self._circle_state[index] == state:
+            return
+        item = self._test_circles[index][0]
+        brush, pen = self._styles[state]
+        item.setBrush(brush)
+        if pen is not None:
+            item.setPen(pen)
+        self._circle_state[index] = state
+
+    def set_pin_states(self, states: dict[str, str], default: str):
+        """Set the circles of the given pin IDs to their state and every other test circle to `default`.
+
+        Only circles whose state changes are updated; the scene repaints them in one pass.
+        """
+        current = self._circle_state
+        not_tested = self._not_tested
+        for i, (_, pins) in enumerate(self._test_circles):
+            state = default
+            for pin in pins:
+                state = self.NOT_TESTED if pin in not_tested else states.get(pin, state)
+            if current[i] != state:
+                self._set_circle(i, state)
+
+    def set_pin_state(self, pin: str, state: str):
+        """Update the circles of one pin ID (live views)."""
+        if pin in self._not_tested:
+            return
+        for i in self._pin_circles.get(pin, ()):
+            self._set_circle(i, state)
+
+    def set_not_tested(self, pins: set[str]):
+        """Show these pin IDs as not tested from now on; other circles leaving that state turn IDLE."""
+        old, self._not_tested = self._not_tested, frozenset(pins)
+        for pin in old | self._not_tested:
+            state = self.NOT_TESTED if pin in self._not_tested else self.IDLE
+            for i in self._pin_circles.get(pin, ()):
+                self._set_circle(i, state)
+
     def set_all_test_circles(self, color: QColor):
-        for item, text in self.left_circles + self.right_circles:
-            if self._is_test_circle(text):
-                item.setBrush(QBrush(color))
+        brush = QBrush(color)
+        for i, (item, _) in enumerate(self._test_circles):
+            item.setBrush(brush)
+            self._circle_state[i] = None  # custom color: next state change repaints it
 
     def set_circles_idle(self):
-        palette = QApplication.palette()
-        btn_color = palette.color(QPalette.ToolTipText)
-        alt_base_color = palette.color(QPalette.AlternateBase)
-        for item, text in self.left_circles + self.right_circles:
-            if self._is_test_circle(text):
-                item.setBrush(QBrush(alt_base_color))
-                item.setPen(QPen(btn_color))
+        self.set_pin_states({}, self.IDLE)
 
     def set_circles_testing(self):
-        palette = QApplication.palette()
-        highlight_color = palette.color(QPalette.Highlight)
-        self.set_all_test_circles(highlight_color)
+        self.set_pin_states({}, self.TESTING)
 
     def set_circles_success(self, problem_pins: set[str] | None = None):
-        green = QColor(0, 200, 0)  # green
-        red = QColor(255, 0, 0)  # red
-        pset = problem_pins or set()
-        for item, text in self.left_circles + self.right_circles:
-            if not self._is_test_circle(text):
-                continue
-            pins = set(self._canonical_pins_from_text(text))
-            item.setBrush(QBrush(red if pins & pset else green))  # red or green
+        self.set_pin_states(dict.fromkeys(problem_pins or (), self.FAIL), self.OK)
 
     def set_circles_failure(self, problem_pins: set[str]):
-        green = QColor(0, 200, 0)  # green
-        red = QColor(255, 0, 0)  # red
-        for item, text in self.left_circles + self.right_circles:
-            if not self._is_test_circle(text):
-                continue
-            pins = set(self._canonical_pins_from_text(text))
-            item.setBrush(QBrush(red if pins & problem_pins else green))  # red or green
+        self.set_pin_states(dict.fromkeys(problem_pins, self.FAIL), self.OK)
 
-    # Click handling for dark square to open logs page
+    # Click handling: dark square opens the logs page, a test circle reports its pin
     def mousePressEvent(self, event):
         try:
+            scene_pos = self.mapToScene(event.position().toPoint())
             if self.usb_square is not None:
-                scene_pos = self.mapToScene(event.position().toPoint())
                 item_pos = self.usb_square.mapFromScene(scene_pos)
                 if self.usb_square.rect().contains(item_pos):
                     self.log_square_clicked.emit()
                     return
+            for item, pins in self._test_circles:
+                if pins and item.contains(item.mapFromScene(scene_pos)):
+                    self.pin_clicked.emit(pins[0])
+                    return
         except Exception:
             pass
         super().mousePressEvent(event)
@@ -255,6 +417,9 @@ class SerialReader(QThread):
         self._ser = None
         self._out_queue = deque()
         self._queue_lock = threading.Lock()
+        # Optional traffic tap: tap(role, "tx"/"rx", line, monotonic_ns), called from this thread
+        self.tap = None
+        self._opened_once = False
 
     def run(self):
         try:
@@ -270,6 +435,9 @@ class SerialReader(QThread):
                     self._ser = None
                     QThread.msleep(500)
                     continue
+                if self._opened_once:
+                    metrics.PORT_RECONNECTS.inc(self.role)
+                self._opened_once = True
             # Read line; if error (e.g., port disappeared), close and retry
             try:
                 data = self._ser.readline()
@@ -304,6 +472,11 @@ class SerialReader(QThread):
                                 cmd = cmd + "\n"
                             self._ser.write(cmd.encode('utf-8'))
                             self._ser.flush()
+                            if self.tap:
+                                try:
+                                    self.tap(self.role, "tx", cmd, time.monotonic_ns())
+                                except Exception:
+                                    pass
                         except Exception:
                             # not successful — return the command and reopen the port later
                             with self._queue_lock:
@@ -324,6 +497,11 @@ class SerialReader(QThread):
             except Exception:
                 continue
             if line:
+                if self.tap:
+                    try:
+                        self.tap(self.role, "rx", line, time.monotonic_ns())
+                    except Exception:
+                        pass
                 self.line_received.emit(self.role, line)
             # After reading a line, try sending queued commands
             try:
@@ -345,6 +523,11 @@ class SerialReader(QThread):
                             cmd = cmd + "\n"
                         self._ser.write(cmd.encode('utf-8'))
                         self._ser.flush()
+                        if self.tap:
+                            try:
+                                self.tap(self.role, "tx", cmd, time.monotonic_ns())
+                            except Exception:
+                                pass
                     except Exception:
                         with self._queue_lock:
                             self._out_queue.appendleft(cmd)
@@ -421,6 +604,7 @@ class FlashWorker(QThread):
         return None
 
     def run(self):
+        t0 = time.monotonic()
         try:
             if self._stop:
                 self.failed.emit("Cancelled")
@@ -464,11 +648,56 @@ class FlashWorker(QThread):
             if dfu_port:
                 exclude.add(dfu_port)
             new_target = self._wait_for_new_port_local(exclude, self.timeout_s)
+            metrics.FLASH_DURATION.observe(time.monotonic() - t0, "ok")
             self.done.emit(dfu_port or "", new_target or "")
         except Exception as e:
+            metrics.FLASH_DURATION.observe(time.monotonic() - t0, "fail")
             self.failed.emit(str(e))
 
 
+class PortWatcher(QThread):
+    """Polls the serial port list and reports devices that newly appear.
+
+    Signals:
+      - ports_listed(list, float): combo items of the first poll and how long it took (s);
+        the window fills its port lists from it instead of scanning at startup
+      - port_added(str, bool): device name of a port that was not present on the previous poll,
+        and whether its USB VID/PID is a tester board's
+    """
+    ports_listed = Signal(list, float)
+    port_added = Signal(str, bool)
+
+    def __init__(self, interval_ms: int = 500):
+        super().__init__(None)
+        self.interval_ms = interval_ms
+        self._stop = False
+
+    def stop(self):
+        self._stop = True
+
+    def run(self):
+        t0 = time.perf_counter()
+        try:
+            from serial.tools import list_ports
+        except Exception:
+            self.ports_listed.emit(["<pyserial not installed>"], time.perf_counter() - t0)
+            return
+        known = None
+        while not self._stop:
+            try:
+                infos = list_ports.comports()
+            except Exception:
+                infos = []
+            current = {p.device: p for p in infos}
+            if known is None:
+                self.ports_listed.emit(port_items(infos), time.perf_counter() - t0)
+            else:
+                for dev in sorted(current.keys() - known):
+                    self.port_added.emit(dev, is_tester_port(current[dev]))
+            known = set(current)
+            QThread.msleep(self.interval_ms)
+
+
 class StatusBox(QWidget):
     def __init__(self, label_text: str, color: QColor, parent=None):
         super().__init__(parent)
@@ -494,8 +723,9 @@ class StatusBox(QWidget):
 
 
 class MainWindow(QWidget):
-    def __init__(self):
+    def __init__(self, startup_timer: StartupTimer | None = None):
         super().__init__(None)
+        self._startup_timer = startup_timer
         self.setWindowTitle("C!N Tester GUI")
         import sys
         if getattr(sys, '_MEIPASS', False):
@@ -564,12 +794,65 @@ class MainWindow(QWidget):
         ports_layout.addWidget(self.master_combo)
         ports_layout.addWidget(self.btn_auto_search)
 
+        # Options group
+        options_group = QGroupBox("Options")
+        options_group.setFont(group_font)
+        options_layout = QVBoxLayout(options_group)
+        self.mode_combo = QComboBox(None)
+        self.mode_combo.addItem("Full diagnostic", "FULL")
+        self.mode_combo.addItem("Fail-fast", "FAST")
+        self.mode_combo.addItem("Retest failed pins", "RETEST")
+        self.mode_combo.setToolTip("Full diagnostic tests every stage and pin (rework bench);\n"
+                                   "Fail-fast stops at the first defect (sorting on the line);\n"
+                                   "Retest checks only the board's last failed pins and their neighbours (after rework)")
+        self.chk_auto_start = QCheckBox("Auto start on insertion")
+        self.chk_auto_start.setToolTip("Start the test when a Target is seated in the fixture or its USB port appears")
+        options_layout.addWidget(QLabel("Test mode:"))
+        options_layout.addWidget(self.mode_combo)
+        self.chk_xtalk = QCheckBox("Crosstalk stage")
+        self.chk_xtalk.setToolTip("Before SEQUENCE, toggle each line (then all at once) on the Target\n"
+                                  "and count coupled glitches on the quiet lines (needs XTALK firmware)")
+        self.chk_xtalk.setEnabled(False)
+        self.chk_clock = QCheckBox("Clock accuracy stage")
+        self.chk_clock.setToolTip("Before SEQUENCE, measure the Target's HF and LF crystals against the Master's\n"
+                                  "(ppm error, about 0.2 s; needs CLOCK firmware)")
+        self.chk_clock.setEnabled(False)
+        self.chk_vcc = QCheckBox("VCC switch stage")
+        self.chk_vcc.setToolTip("Before SEQUENCE, time the Target's VCC switch off and on and watch the rail\n"
+                                "for dropouts with every line HIGH (about 0.1 s; needs VCC firmware)")
+        self.chk_vcc.setEnabled(False)
+        self.chk_golden = QCheckBox("Compare with golden board")
+        self.chk_golden.setToolTip("Check each run's pin timing and VCC transitions against the signature\n"
+                                   "learned on a known-good board in this fixture (tolerance bands)")
+        self.btn_learn_golden = QPushButton("Learn golden")
+        self.btn_learn_golden.setCheckable(True)
+        self.btn_learn_golden.setToolTip(f"Learn this fixture's signature from the next {LEARN_RUNS} passing\n"
+                                         "Full diagnostic runs of a known-good board")
+        self.skip_combo = QComboBox(None)
+        for text, hours in (("Off", 0), ("1 hour", 1), ("8 hours", 8), ("24 hours", 24), ("7 days", 168)):
+            self.skip_combo.addItem(text, hours)
+        self.skip_combo.setToolTip("Do not retest a Target whose chip ID passed within this time\n"
+                                   "(boards mixed up in trays; needs ID firmware)")
+        options_layout.addWidget(self.chk_auto_start)
+        options_layout.addWidget(self.chk_xtalk)
+        options_layout.addWidget(self.chk_clock)
+        options_layout.addWidget(self.chk_vcc)
+        options_layout.addWidget(self.chk_golden)
+        options_layout.addWidget(self.btn_learn_golden)
+        options_layout.addWidget(QLabel("Skip boards passed within:"))
+        options_layout.addWidget(self.skip_combo)
+
         # Buttons group
         buttons_group = QWidget(None)
         buttons_layout = QHBoxLayout(buttons_group)
         self.btn_flash = QPushButton("Flash")
         self.btn_run = QPushButton("Run Test")
         self.btn_flash_run = QPushButton("Flash&&Run")
+        self.btn_monitor = QPushButton("Monitor")
+        self.btn_monitor.setCheckable(True)
+        self.btn_monitor.setEnabled(False)
+        self.btn_monitor.setToolTip("Hold every Target pin HIGH and show the contacts the Master sees, live\n"
+                                    "(press pogo pins or wiggle the board to find intermittent contacts)")
 
         font = QFont()
         font.setBold(True)
@@ -593,11 +876,13 @@ class MainWindow(QWidget):
         buttons_layout.addWidget(self.btn_flash)
         buttons_layout.addWidget(self.btn_run)
         buttons_layout.addWidget(self.btn_flash_run)
+        buttons_layout.addWidget(self.btn_monitor)
 
         # Assemble controls
         controls_layout.addWidget(test_group)
         controls_layout.addWidget(ready_group)
         controls_layout.addWidget(ports_group)
+        controls_layout.addWidget(options_group)
         controls_layout.addWidget(buttons_group)
 
         # Main layout switched to stacked with logs page
@@ -626,6 +911,26 @@ class MainWindow(QWidget):
 
         top_layout.addStretch(1)
 
+        # Timeline trace toggle (left of C)
+        self.btn_trace = QPushButton("T", top_bar)
+        self.btn_trace.setFixedWidth(24)
+        self.btn_trace.setCheckable(True)
+        self.btn_trace.setToolTip("Record a Perfetto/Chrome timeline trace of each run")
+        top_layout.addWidget(self.btn_trace)
+
+        # Serial capture toggle (left of C)
+        self.btn_capture = QPushButton("R", top_bar)
+        self.btn_capture.setFixedWidth(24)
+        self.btn_capture.setCheckable(True)
+        self.btn_capture.setToolTip("Record the serial traffic of each run (replay with main.py --replay)")
+        top_layout.addWidget(self.btn_capture)
+
+        # Journal download (left of C)
+        self.btn_journal = QPushButton("J", top_bar)
+        self.btn_journal.setFixedWidth(24)
+        self.btn_journal.setToolTip("Download the Master's on-flash result journal (standalone runs)")
+        top_layout.addWidget(self.btn_journal)
+
         # Clear logs button (left of X)
         self.btn_clear = QPushButton("C", top_bar)
         self.btn_clear.setFixedWidth(24)
@@ -664,25 +969,46 @@ class MainWindow(QWidget):
 
         # Navigation wiring
         self.pinout_view.log_square_clicked.connect(self.show_logs_page)
+        self.pinout_view.pin_clicked.connect(self.on_pin_clicked)
         self.btn_back.clicked.connect(self.show_main_page)
         self.btn_clear.clicked.connect(self.clear_logs)
+        self.btn_journal.clicked.connect(self.on_download_journal)
+        self.btn_trace.setChecked(QSettings("aroum", "C!N Tester GUI").value("trace_runs", False, type=bool))
+        self.btn_trace.toggled.connect(self.on_trace_toggled)
+        self.btn_capture.setChecked(QSettings("aroum", "C!N Tester GUI").value("capture_runs", False, type=bool))
+        self.btn_capture.toggled.connect(lambda checked: QSettings("aroum", "C!N Tester GUI").setValue("capture_runs", checked))
+        self.chk_auto_start.setChecked(QSettings("aroum", "C!N Tester GUI").value("auto_start", False, type=bool))
+        self.chk_auto_start.toggled.connect(self.on_auto_start_toggled)
+        self.chk_xtalk.setChecked(QSettings("aroum", "C!N Tester GUI").value("xtalk_stage", False, type=bool))
+        self.chk_xtalk.toggled.connect(lambda checked: QSettings("aroum", "C!N Tester GUI").setValue("xtalk_stage", checked))
+        self.chk_clock.setChecked(QSettings("aroum", "C!N Tester GUI").value("clock_stage", False, type=bool))
+        self.chk_clock.toggled.connect(lambda checked: QSettings("aroum", "C!N Tester GUI").setValue("clock_stage", checked))
+        self.chk_vcc.setChecked(QSettings("aroum", "C!N Tester GUI").value("vcc_stage", False, type=bool))
+        self.chk_vcc.toggled.connect(lambda checked: QSettings("aroum", "C!N Tester GUI").setValue("vcc_stage", checked))
+        self.chk_golden.setChecked(QSettings("aroum", "C!N Tester GUI").value("golden_check", True, type=bool))
+        self.chk_golden.toggled.connect(lambda checked: QSettings("aroum", "C!N Tester GUI").setValue("golden_check", checked))
+        self.btn_learn_golden.toggled.connect(self.on_learn_golden_toggled)
+        saved_mode = QSettings("aroum", "C!N Tester GUI").value("test_mode", "FULL", type=str)
+        self.mode_combo.setCurrentIndex(max(0, self.mode_combo.findData(saved_mode)))
+        self.mode_combo.currentIndexChanged.connect(
+            lambda _: QSettings("aroum", "C!N Tester GUI").setValue("test_mode", self.mode_combo.currentData()))
+        saved_skip = QSettings("aroum", "C!N Tester GUI").value("skip_passed_h", 0, type=int)
+        self.skip_combo.setCurrentIndex(max(0, self.skip_combo.findData(saved_skip)))
+        self.skip_combo.currentIndexChanged.connect(
+            lambda _: QSettings("aroum", "C!N Tester GUI").setValue("skip_passed_h", self.skip_combo.currentData()))
         # Fix window size to prevent resizing
         self.setFixedSize(self.sizeHint())
 
-        # Populate COM ports initially
-        refresh_ports_for(self.master_combo)
-        refresh_ports_for(self.target_combo)
-
-        # Load saved COM-port selections, if available
-        try:
-            self._load_saved_ports()
-        except Exception:
-            pass
+        # COM ports are listed by the port watcher in the background once the
+        # window is shown (_finish_startup); saved selections are applied then
+        self.master_combo.addItem(SCANNING_ITEM)
+        self.target_combo.addItem(SCANNING_ITEM)
 
         # Wire up buttons
         self.btn_flash.clicked.connect(self.on_flash)
         self.btn_run.clicked.connect(self.on_run_test)
         self.btn_flash_run.clicked.connect(self.on_flash_and_run)
+        self.btn_monitor.toggled.connect(self.on_monitor_toggled)
         self.btn_auto_search.clicked.connect(self.on_auto_search)
 
         # Refresh ports when user opens a dropdown, and reset error style
@@ -700,14 +1026,114 @@ class MainWindow(QWidget):
         self._master_ready = False
         self._target_ready = False
         self._last_action = None
+        # Verdict line of the last run: {"MODE": .., "VERDICT": .., "HIGH": .., "LOW": .., "SEQ": ..}
+        self._last_result: dict[str, str] = {}
+        # Timeline trace of the current run (None when tracing is off)
+        self._trace: RunTrace | None = None
+        # Serial capture of the current run (None when recording is off)
+        self._capture: CaptureWriter | None = None
+        # Last DESC line per role, stored as context at the start of each capture
+        self._desc_lines: dict[str, str] = {}
+        # Set by attach_replay_ports: readers are replay stand-ins, ports are not opened
+        self._replaying = False
+        # SPC: station charts (loaded on the first finished run) and this run's per-pin samples
+        self._spc: SpcTracker | None = None
+        self._pin_samples: dict[str, dict[str, float]] = {}
+        # Golden board: the station's signature (loaded on first use), the runs collected in
+        # learn mode, this run's VCC transition times and its values outside the bands
+        self._golden: GoldenSignature | None = None
+        self._golden_runs: list[dict[str, float]] = []
+        self._vcc_values: dict[str, float] = {}
+        self._golden_deviations: list[tuple[str, float, float, float]] = []
+        # Board identity (ID?): the Target of the current run, the result history and the
+        # history line to log once the run's START has cleared the logs
+        self._board: BoardIdentity | None = None
+        self._board_note: str | None = None
+        self._history: BoardHistory | None = None
+        self._id_wait = 0  # token of the ID? a requested START waits for (0: none)
+        # RETEST: failed pins of the last run (for Targets without ID?) and this run's pin mask
+        self._last_problem_pins: set[str] = set()
+        self._run_mask: int | None = None  # None: every pin
+        # Pins left out of every run on this station (unpopulated pads of a SKU), per profile
+        self._excluded_pins: set[str] = set()
+        self._retest_note: str | None = None  # logged once START has cleared the logs
+        # Live contact monitor: pin IDs in test order, the latest levels and the lines
+        # that read LOW at any sample since the last repaint (a flicker stays visible)
+        self._mon_pins: list[str | None] = []
+        self._mon_levels = 0
+        self._mon_low_seen = 0
+        self._mon_changes = 0
+        self._mon_last_us = 0
+        self._mon_paint = QTimer(self)
+        self._mon_paint.setInterval(33)  # repaint at ~30 fps however fast MON lines arrive
+        self._mon_paint.timeout.connect(self._paint_monitor)
+        # Session watchdog: stage deadlines of the current run, polled while it is armed
+        self._watchdog = SessionWatchdog()
+        self._watchdog_timer = QTimer(self)
+        self._watchdog_timer.setInterval(250)
+        self._watchdog_timer.timeout.connect(self._poll_watchdog)
+        # Station metrics: run start and per-stage AWAIT timestamps (monotonic)
+        self._run_started: float | None = None
+        self._stage_t0: dict[str, float] = {}
+        # HELLO? descriptors per role (None: not answered yet, or legacy firmware)
+        self._desc: dict[str, Descriptor | None] = {"master": None, "target": None}
+        # Paced run: each Master check is released by the Target's ack
+        self._paced = False
+        self._pin_outstanding: float | None = None  # monotonic time of the Target NEXT_PIN
+        self._pins_sent = 0
+        # Crosstalk sweep: aggressors still to toggle (None: not running) and the
+        # coupled glitch counts {(aggressor, victim): count} of this run
+        self._xtalk_queue: list[str] | None = None
+        self._xtalk_done = False
+        self._xtalk_counts: dict[tuple[str, str], int] = {}
+        # Clock stage: clocks still to measure (None: not running) and the ppm results
+        self._clock_queue: list[str] | None = None
+        self._clock_done = False
+        self._clock_results: dict[str, str] = {}
+        # VCC switch stage: waiting for the Master's result, and whether it ran this run
+        self._vcc_running = False
+        self._vcc_done = False
+        # JOURNAL? download in progress (Master on-flash result journal)
+        self._journal_collector = JournalCollector()
+        # Auto start: new serial ports are reported by the watcher thread
+        self.port_watcher = PortWatcher()
+        self.port_watcher.ports_listed.connect(self._on_ports_listed)
+        self.port_watcher.port_added.connect(self._on_port_added)
 
         # Restart readers on selection change
         self.master_combo.currentTextChanged.connect(self.restart_readers)
         self.target_combo.currentTextChanged.connect(self.restart_readers)
 
-        # Initial idle circles and start readers (deferred until event loop starts)
+        # Initial idle circles; the rest of startup runs once the event loop shows the window
         self.pinout_view.set_circles_idle()
-        QTimer.singleShot(0, self.restart_readers)
+        QTimer.singleShot(0, self._finish_startup)
+
+    def _finish_startup(self):
+        """Second startup phase, after the first paint: metrics server and the
+        background port scan, which starts the readers when it reports."""
+        if self._startup_timer:
+            self._startup_timer.mark("shown")
+        self._start_metrics_server()
+        if not self._replaying:
+            self.port_watcher.start()
+
+    def _on_ports_listed(self, items: list, scan_s: float):
+        for combo in (self.master_combo, self.target_combo):
+            combo.blockSignals(True)
+            combo.clear()
+            combo.addItems(items)
+        try:
+            self._load_saved_ports()
+        except Exception:
+            pass
+        for combo in (self.master_combo, self.target_combo):
+            combo.blockSignals(False)
+        self.restart_readers()
+        timer = self._startup_timer
+        if timer:
+            timer.mark_background("ports", scan_s)
+            self._log_info(timer.summary())
+            self._startup_timer = None
 
     def _set_combo_to_device(self, combo: QComboBox, device: str | None):
         if not device:
@@ -747,7 +1173,7 @@ class MainWindow(QWidget):
         except Exception:
             pass
         # We search for all attributes ending with '_reader' or '_flash_worker'
-        worker_suffixes = ("_reader", "_flash_worker")
+        worker_suffixes = ("_reader", "_flash_worker", "_watcher")
         worker_attrs = [attr for attr in dir(self) if attr.endswith(worker_suffixes)]
 
         active_threads = []
@@ -790,6 +1216,869 @@ class MainWindow(QWidget):
         except Exception:
             pass
 
+    # --- Auto start on insertion ---
+    def _auto_start_stable_ms(self) -> int:
+        """Contact stability the Master requires before TARGET_SEATED (0 = auto start off)."""
+        if not self.chk_auto_start.isChecked():
+            return 0
+        return max(50, QSettings("aroum", "C!N Tester GUI").value("auto_start_stable_ms", 500, type=int))
+
+    def on_auto_start_toggled(self, checked: bool):
+        QSettings("aroum", "C!N Tester GUI").setValue("auto_start", checked)
+        if self.master_reader:
+            self.master_reader.send_line(f"AUTOSTART {self._auto_start_stable_ms()}")
+
+    def _run_in_progress(self) -> bool:
+        worker = getattr(self, "_flash_worker", None)
+        flashing = worker is not None and worker.isRunning()
+        # A run without a verdict for a minute is treated as abandoned
+        running = self._run_started is not None and time.monotonic() - self._run_started < 60.0
+        return flashing or running
+
+    def _on_port_added(self, device: str, tester: bool):
+        """A new serial port appeared: with auto start on, a tester board's port is a freshly inserted Target."""
+        if not self.chk_auto_start.isChecked() or self._run_in_progress() or self._await_target_ready:
+            return
+        if device == parse_device_from_item(self.master_combo.currentText()):
+            return
+        if not tester:
+            # Any other USB serial device (adapter, DFU bootloader) keeps the Target selection
+            self._log_info(f"Auto start: ignoring new COM {device}, not a tester board")
+            return
+        self._log_info(f"Auto start: new Target COM detected: {device}")
+        refresh_ports_for(self.target_combo)
+        self._set_combo_to_device(self.target_combo, device)
+        try:
+            self._save_ports()
+        except Exception:
+            pass
+        self.restart_readers()
+        # Start as soon as the Target speaks (same path as Flash&Run)
+        self._last_action = "run"
+        self._await_target_ready = True
+
+    # --- Run result ---
+    def _on_run_result(self, line: str):
+        """Parse 'Master: RESULT MODE=.. VERDICT=.. HIGH=.. LOW=.. SEQ=..' into _last_result."""
+        self.master_log.appendPlainText(line)
+        result = {}
+        for token in line.split()[2:]:
+            key, sep, value = token.partition("=")
+            if sep:
+                result[key.upper()] = value
+        self._last_result = result
+        self._stage_finished("sequence")  # a FULL run with failed pins has no ALL OK
+        for key in ("HIGH", "LOW", "SEQ", "XTALK"):
+            self.problem_pins |= self._extract_pins_from_message(result.get(key, ""))
+        if result.get("VCC", "-") != "-":
+            # The VCC switch failed: mark the VCC pad (test line 0, 'P0.13 VCC' in the pinout)
+            self.problem_pins.add(pin_id(self._master_profile().labels[0]))
+        self._check_golden(result)
+
+    # --- Golden-board signature (golden.py) ---
+    def _golden_signature(self) -> GoldenSignature:
+        if self._golden is None:
+            station = re.sub(r'[^A-Za-z0-9_.-]', '_', self._station_name())
+            self._golden = GoldenSignature(os.path.join(traces_dir(), f"golden_{station}.json"))
+        return self._golden
+
+    def _golden_context(self) -> dict:
+        return {"profile": self._master_profile().name, "paced": self._paced}
+
+    def on_learn_golden_toggled(self, on: bool):
+        self._golden_runs.clear()
+        if on:
+            self._log_info(f"Golden: learn mode — run a known-good board {LEARN_RUNS} times in Full diagnostic")
+
+    def _check_golden(self, result: dict[str, str]):
+        """RESULT: learn the run into the golden signature, or check it against the bands."""
+        if self._replaying:
+            return
+        run = flatten(self._pin_samples, self._vcc_values)
+        if self.btn_learn_golden.isChecked():
+            self._learn_golden(result, run)
+            return
+        if not self.chk_golden.isChecked() or not run:
+            return
+        golden = self._golden_signature()
+        if not golden.learned:
+            return
+        if golden.context != self._golden_context():
+            self._log_info(f"Golden: signature learned for {golden.context} — not compared")
+            return
+        deviations = golden.compare(run)
+        if not deviations:
+            self._log_info(f"Golden: {len(run)} values within the bands")
+            return
+        self._golden_deviations = deviations
+        vcc_pad = pin_id(self._master_profile().labels[0])  # the pinout's 'P0.13 VCC' pad
+        pins = {vcc_pad if key.startswith("VCC/") else key.partition("/")[0] for key, *_ in deviations}
+        self.problem_pins |= pins
+        self._last_result["GOLDEN"] = ",".join(sorted(pins))
+        more = f" (+{len(deviations) - 8} more)" if len(deviations) > 8 else ""
+        self._log_info("Golden: " + "; ".join(describe(d) for d in deviations[:8]) + more)
+
+    def _learn_golden(self, result: dict[str, str], run: dict[str, float]):
+        if result.get("VERDICT") != "PASS" or result.get("MODE") != "FULL" or "TESTED" in result or not run:
+            self._golden_runs.clear()
+            self._log_info("Golden: only passing Full diagnostic runs of every pin are learned — "
+                           "start again with a known-good board")
+            return
+        self._golden_runs.append(run)
+        if len(self._golden_runs) < LEARN_RUNS:
+            self._log_info(f"Golden: learned run {len(self._golden_runs)} of {LEARN_RUNS}")
+            return
+        golden = self._golden_signature()
+        golden.learn(self._golden_runs, self._golden_context())
+        self._golden_runs.clear()
+        try:
+            golden.save()
+        except OSError as e:
+            self._log_info(f"Golden: error — {e}")
+        self._log_info(f"Golden: signature learned from {golden.runs} runs — {len(golden.values)} values")
+        self.btn_learn_golden.setChecked(False)
+
+    # --- Station metrics ---
+    def _start_metrics_server(self):
+        endpoint = os.environ.get("CN_TESTER_METRICS") or QSettings("aroum", "C!N Tester GUI").value(
+            "metrics_endpoint", metrics.DEFAULT_ENDPOINT, type=str)
+        try:
+            self._metrics_server = metrics.start_server(endpoint)
+            if self._metrics_server:
+                self._log_info(f"Metrics: serving on {endpoint}")
+        except Exception as e:
+            self._metrics_server = None
+            self._log_info(f"Metrics: disabled — {e}")
+
+    def _stage_awaited(self, stage: str):
+        self._stage_t0[stage] = time.monotonic()
+        self._watchdog.stage(stage, self._stage_t0[stage])
+
+    def _stage_finished(self, stage: str):
+        t0 = self._stage_t0.pop(stage, None)
+        if t0 is not None:
+            metrics.STAGE_LATENCY.observe(time.monotonic() - t0, stage)
+
+    def _run_finished(self, result: str):
+        if self._run_started is None:
+            return
+        duration_s = time.monotonic() - self._run_started
+        metrics.record_run(result, duration_s)
+        self._run_started = None
+        self._stop_watchdog()
+        self._update_spc()
+        self._record_board_run(result, duration_s)
+        self._last_problem_pins = set(self.problem_pins) if result == "fail" else set()
+
+    def _station_name(self) -> str:
+        return QSettings("aroum", "C!N Tester GUI").value("station_name", platform.node() or "station", type=str)
+
+    # --- Statistical process control (spc.py) ---
+    def _on_pin_ok(self, line: str):
+        """'SEQUENCE: OK — P0_06 settle_us=812': keep the pin's latency and settle time for SPC."""
+        pins = self._extract_pins_from_message(line)
+        t0 = self._stage_t0.get("pin")
+        if len(pins) != 1:
+            return
+        sample = self._pin_samples.setdefault(pins.pop(), {})
+        if t0 is not None:
+            sample["latency_s"] = time.monotonic() - t0
+        m = re.search(r"settle_us=(\d+)", line)
+        if m:
+            sample["settle_us"] = float(m.group(1))
+
+    def _update_spc(self):
+        """Feed the finished run into the per-pin control charts and report pins drifting out of control."""
+        samples, self._pin_samples = self._pin_samples, {}
+        if self._replaying or not (samples or self.problem_pins):
+            return
+        if self._spc is None:
+            station = self._station_name()
+            self._spc = SpcTracker(os.path.join(traces_dir(), f"spc_{re.sub(r'[^A-Za-z0-9_.-]', '_', station)}.json"))
+        spc = self._spc
+        for pin in sorted(samples.keys() | self.problem_pins):
+            sample = samples.get(pin, {})
+            sample["fail"] = 1.0 if pin in self.problem_pins else 0.0
+            for stat, value in sample.items():
+                alarm = spc.observe(pin, stat, value)
+                if alarm:
+                    self._log_info(alarm)
+        metrics.set_spc_alarms(spc.out_of_control())
+        try:
+            spc.save()
+        except OSError as e:
+            self._log_info(f"SPC: error — {e}")
+
+    # --- Board identity (ID?) and result history (board_history.py) ---
+    def _board_history(self) -> BoardHistory:
+        if self._history is None:
+            os.makedirs(traces_dir(), exist_ok=True)
+            self._history = BoardHistory(os.path.join(traces_dir(), "board_history.sqlite"))
+        return self._history
+
+    def _request_start(self):
+        """Both boards READY for a requested run: identify the Target first when it can answer ID?."""
+        target = self._desc["target"]
+        if target is not None and target.has(FEAT_ID) and self.target_reader and not self._replaying:
+            if self._id_wait:
+                return
+            self._board = None
+            self._id_wait = token = time.monotonic_ns()
+            self.target_reader.send_line("ID?")
+            QTimer.singleShot(1000, lambda: self._on_id_timeout(token))
+            return
+        self._send_start()
+
+    def _send_start(self):
+        mode = self.mode_combo.currentData()
+        sku = self._sku_mask()
+        self._run_mask = sku
+        if mode == "RETEST":
+            mask = self._retest_mask()
+            if sku is not None:
+                mask &= sku
+            if mask:
+                self._run_mask = mask
+                mode = f"RETEST {mask:X}"
+            else:
+                mode = "FULL"
+        if sku is not None and not mode.startswith("RETEST"):
+            mode = f"{mode} {sku:X}"
+        if self.master_reader:
+            self.master_reader.send_line(f"START {mode}")
+
+    def _master_profile(self):
+        master = self._desc["master"]
+        return PROFILES.get((master and master.profile) or DEFAULT_PROFILE.name, DEFAULT_PROFILE)
+
+    def _sku_mask(self) -> int | None:
+        """Mask of the pins not excluded by the operator; None tests every pin."""
+        if not self._excluded_pins:
+            return None
+        if not self._both_have(FEAT_PIN_MASK):
+            self._log_info("WARNING: firmware without pin masks — excluded pins are tested too")
+            return None
+        profile = self._master_profile()
+        return pin_mask(profile, {pin_id(label) for label in profile.labels} - self._excluded_pins)
+
+    def _stage_command(self, name: str) -> str:
+        """START_ALL_HIGH / START_ALL_LOW / START_SEQUENCE carrying this run's pin mask."""
+        return f"{name} {self._run_mask:X}" if self._run_mask is not None else name
+
+    def _untested_pins(self) -> set[str]:
+        """Pin IDs outside this run's mask (excluded pads and pins a RETEST leaves out)."""
+        if self._run_mask is None:
+            return set()
+        profile = self._master_profile()
+        return {pin_id(label) for i, label in enumerate(profile.labels) if not self._run_mask >> i & 1}
+
+    def _load_excluded_pins(self):
+        profile = self._master_profile()
+        saved = QSettings("aroum", "C!N Tester GUI").value(f"excluded_pins/{profile.name}", "", type=str)
+        known = {pin_id(label) for label in profile.labels}
+        self._excluded_pins = {pin for pin in saved.split(",") if pin in known}
+        self.pinout_view.set_not_tested(self._excluded_pins)
+        if self._excluded_pins:
+            self._log_info(f"Not tested: {', '.join(sorted(self._excluded_pins))}")
+
+    def on_pin_clicked(self, pin: str):
+        """Toggle a pad in or out of the runs (pads a board variant does not populate)."""
+        if self._run_started is not None or self.btn_monitor.isChecked() or self._replaying:
+            return
+        profile = self._master_profile()
+        pins = {pin_id(label) for label in profile.labels}
+        excluded = self._excluded_pins ^ {pin}
+        if not pins - excluded:
+            return  # a run tests at least one pin
+        self._excluded_pins = excluded
+        QSettings("aroum", "C!N Tester GUI").setValue(f"excluded_pins/{profile.name}",
+                                                       ",".join(sorted(excluded)))
+        self.pinout_view.set_not_tested(excluded)
+        self._log_info(f"Not tested: {', '.join(sorted(excluded))}" if excluded else "Not tested: none")
+
+    def _retest_mask(self) -> int:
+        """Mask of the board's last failed pins and their physical neighbours; 0 runs FULL instead."""
+        if not self._both_have(FEAT_PIN_MASK):
+            self._log_info("RETEST: firmware without pin masks — running FULL")
+            return 0
+        if self._board is not None:
+            runs = self._board_history().runs(self._board.devid, 1)
+            failed = self._extract_pins_from_message(runs[0].defects) if runs else set()
+        else:
+            failed = set(self._last_problem_pins)
+        if not failed:
+            self._log_info("RETEST: no failed pins recorded for this board — running FULL")
+            return 0
+        profile = PROFILES.get(self._desc["master"].profile or DEFAULT_PROFILE.name, DEFAULT_PROFILE)
+        pins = with_neighbours(profile, failed)
+        self._retest_note = (f"RETEST: {', '.join(sorted(failed))} and neighbours — "
+                             f"{len(pins)} of {len(profile.labels)} pins")
+        return pin_mask(profile, pins)
+
+    def _run_pin_count(self) -> int:
+        target = self._desc["target"]
+        count = target.pins if target else 0
+        return bin(self._run_mask).count("1") if self._run_mask is not None else count
+
+    def _on_id_timeout(self, token: int):
+        if self._id_wait != token:
+            return
+        self._id_wait = 0
+        self._log_info("WARNING: Target did not answer ID?; the run is not recorded by board")
+        self._send_start()
+
+    def _on_identity(self, line: str):
+        ident = parse_identity(line)
+        if ident is None:
+            return
+        self._board = ident
+        try:
+            history = self._board_history()
+            history.seen(ident)
+            runs = history.runs(ident.devid)
+        except Exception as e:
+            self._log_info(f"History: error — {e}")
+            history, runs = None, []
+        note = f"Target: {ident.summary()} — " + (describe_runs(runs) if runs else "first run")
+        if not self._id_wait:
+            self._log_info(note)  # run already started (button or auto start)
+            return
+        self._id_wait = 0
+        hours = self.skip_combo.currentData()
+        prior = history.passed_since(ident.devid, time.time() - hours * 3600) if history and hours else None
+        if prior is not None:
+            self._skip_board(note)
+            return
+        self._board_note = note
+        self._send_start()
+
+    def _skip_board(self, note: str):
+        """The Target already passed within the skip window: end the run without testing."""
+        self._run_started = None
+        self._stop_watchdog()
+        self._last_action = None
+        self._log_info(note)
+        self._log_info(f"SKIPPED: board {self._board.devid} already passed within "
+                       f"{self.skip_combo.currentText()} — not retested")
+        self.set_success_state()
+        for btn in (self.btn_run, self.btn_flash, self.btn_flash_run):
+            self._set_btn_state(btn, "idle")
+
+    def _start_rejected(self):
+        """The Master refused START (bad mode or mask): nothing ran, back to idle."""
+        self._log_info("START rejected by the Master — run not started")
+        self._run_started = None
+        self._stop_watchdog()
+        self._finish_trace()
+        self._finish_capture()
+        self.set_idle_state()
+        for btn in (self.btn_run, self.btn_flash, self.btn_flash_run):
+            self._set_btn_state(btn, "idle")
+        self._last_action = None
+
+    def _record_board_run(self, result: str, duration_s: float):
+        board = self._board
+        if board is None or self._replaying:
+            return
+        r = self._last_result
+        defects = " ".join(f"{key}={r[key]}" for key in ("HIGH", "LOW", "SEQ", "XTALK", "CLOCK", "VCC", "GOLDEN")
+                           if r.get(key, "-") not in ("", "-"))
+        try:
+            self._board_history().record_run(board.devid, result, r.get("MODE", self.mode_combo.currentData()),
+                                             defects, duration_s, self._station_name())
+        except Exception as e:
+            self._log_info(f"History: error — {e}")
+
+    # --- Capability negotiation (HELLO? / DESC) ---
+    def _on_descriptor(self, role: str, line: str):
+        desc = parse_desc(line)
+        if desc is None:
+            return
+        self._desc[role] = desc
+        self._desc_lines[role] = line
+        self._log_info(f"{role.capitalize()}: {desc.summary()}")
+        profile = PROFILES.get(desc.profile or DEFAULT_PROFILE.name)
+        expected = expected_pin_hash(desc.profile)
+        if profile is None:
+            self._log_info(f"WARNING: {role} reports unknown board profile '{desc.profile}'")
+            self.mark_combo_error(self.master_combo if role == "master" else self.target_combo)
+        elif desc.pinhash != expected:
+            self._log_info(f"WARNING: {role} pin map differs from profile {profile.name} (pinhash {desc.pinhash:08X})")
+            self.mark_combo_error(self.master_combo if role == "master" else self.target_combo)
+        elif role == "master":
+            # The Master's harness decides which pads are drawn
+            self.pinout_view.set_rows(profile.pin_rows)
+            self.pinout_view.set_circles_idle()
+            self._load_excluded_pins()
+        other = self._desc["target" if role == "master" else "master"]
+        if other is not None and (other.profile or DEFAULT_PROFILE.name) != (desc.profile or DEFAULT_PROFILE.name):
+            self._log_info("WARNING: Master and Target were built for different board profiles")
+        elif other is not None and other.pinhash != desc.pinhash:
+            self._log_info("WARNING: Master and Target were built from different pin maps")
+        if role == "master":
+            self.mode_combo.setEnabled(desc.has(FEAT_MODES))
+            self.chk_auto_start.setEnabled(desc.has(FEAT_AUTOSTART))
+        self.chk_xtalk.setEnabled(self._xtalk_supported())
+        self.chk_clock.setEnabled(self._both_have(FEAT_CLOCK))
+        self.chk_vcc.setEnabled(self._both_have(FEAT_VCC))
+        self.btn_monitor.setEnabled(self._both_have(FEAT_MONITOR))
+
+    # --- Result journal (JOURNAL?) ---
+    def on_download_journal(self):
+        if not self.master_reader or not self.master_reader.send_line("JOURNAL?"):
+            self._log_info("Journal: connect the Master first")
+            return
+        self._log_info("Journal: downloading...")
+
+    def _on_journal_line(self, line: str):
+        journal = self._journal_collector.feed(line)
+        if journal is None:
+            return
+        os.makedirs(traces_dir(), exist_ok=True)
+        path = os.path.join(traces_dir(), time.strftime("journal_%Y%m%d_%H%M%S.csv"))
+        try:
+            write_csv(path, journal)
+            self._log_info(f"Journal: {journal.summary()} — saved {path}")
+        except Exception as e:
+            self._log_info(f"Journal: error — {e}")
+
+    def _paced_supported(self) -> bool:
+        master, target = self._desc["master"], self._desc["target"]
+        return master is not None and master.proto >= 2 and target is not None and target.has(FEAT_PIN_ACK)
+
+    def _send_target_next_pin(self):
+        if self.target_reader and self.target_reader.send_line("NEXT_PIN"):
+            self._pin_outstanding = time.monotonic()
+            self._pins_sent += 1
+
+    def _on_target_ack(self, uline: str):
+        """Paced run: release the Master check that matches a Target ack."""
+        if "PIN_UP" in uline:
+            if self.master_reader:
+                self.master_reader.send_line("NEXT_PIN")
+        elif "ALL_HIGH: OK" in uline:
+            if self.master_reader:
+                self.master_reader.send_line(self._stage_command("START_ALL_HIGH"))
+        elif "ALL_LOW: OK" in uline:
+            if self.master_reader:
+                self.master_reader.send_line(self._stage_command("START_ALL_LOW"))
+
+    # --- Optional stages between ALL_LOW and SEQUENCE (XTALK, CLOCK) ---
+    def _both_have(self, feature: int) -> bool:
+        master, target = self._desc["master"], self._desc["target"]
+        return master is not None and master.has(feature) and target is not None and target.has(feature)
+
+    def _xtalk_supported(self) -> bool:
+        return self._both_have(FEAT_XTALK)
+
+    def _advance_pre_sequence(self):
+        """Run the next enabled optional stage; once all are done, start SEQUENCE."""
+        if self._start_xtalk() or self._start_clock() or self._start_vcc():
+            return
+        self._start_sequence()
+
+    def _start_sequence(self):
+        self._stage_awaited("sequence")
+        if self.master_reader: self.master_reader.send_line(self._stage_command("START_SEQUENCE"))
+        if self.target_reader: self.target_reader.send_line(self._stage_command("START_SEQUENCE"))
+
+    def _line_in_run(self, index: int) -> bool:
+        return self._run_mask is None or bool(self._run_mask >> index & 1)
+
+    def _start_xtalk(self) -> bool:
+        """Run the crosstalk sweep before SEQUENCE when enabled; False when it is skipped."""
+        if self._xtalk_done or not self.chk_xtalk.isChecked() or not self._xtalk_supported():
+            return False
+        if not self.target_reader or not self.master_reader:
+            return False
+        self._xtalk_done = True
+        self._xtalk_counts.clear()
+        # Index 0 is the VCC line: a victim only, it switches the Target power.
+        # Lines outside the run's mask are neither toggled nor counted.
+        mask = self._run_mask if self._run_mask is not None else ~0
+        self._xtalk_queue = [str(i) for i in range(1, self._desc["target"].pins) if mask >> i & 1] + ["ALL"]
+        self._stage_awaited("xtalk")
+        self._xtalk_next()
+        return True
+
+    def _xtalk_next(self):
+        """Toggle the next aggressor on the Target; its XTALK_UP releases the Master count."""
+        if not self._xtalk_queue:
+            self._xtalk_queue = None
+            if self.target_reader: self.target_reader.send_line("XTALK STOP")
+            return
+        if self.target_reader: self.target_reader.send_line(f"XTALK {self._xtalk_queue.pop(0)}")
+
+    def _on_xtalk_line(self, role: str, line: str):
+        """Pace the sweep: Target XTALK_UP -> Master XTALK -> next aggressor -> XTALK_DONE."""
+        uline = line.upper()
+        (self.master_log if role == "master" else self.target_log).appendPlainText(line)
+        if role == "target":
+            if "XTALK_UP" in uline:
+                if self.master_reader: self.master_reader.send_line(f"XTALK {line.split()[-1]}")
+            elif "XTALK_REJECTED" in uline:
+                self._xtalk_next()
+            elif "XTALK_DONE" in uline:
+                self._stage_finished("xtalk")
+                self._log_xtalk_summary()
+                self._advance_pre_sequence()
+            return
+        parts = line.split()
+        if len(parts) < 5 or parts[2].upper() in ("BUSY", "REJECTED"):
+            self._xtalk_queue = []  # Master cannot count now: stop the Target and go on
+        elif parts[4] != "-":
+            for pair in parts[4].split(","):
+                victim, _, count = pair.rpartition("=")
+                self._xtalk_counts[(parts[2], victim)] = int(count)
+        if self._xtalk_queue is not None:
+            self._xtalk_next()
+
+    def _log_xtalk_summary(self):
+        pairs = sorted(self._xtalk_counts.items(), key=lambda kv: kv[1], reverse=True)
+        worst = ", ".join(f"{a}→{v} ({n})" for (a, v), n in pairs[:5])
+        self._log_info(f"Crosstalk: {len(pairs)} coupled pairs" + (f" — {worst}" if worst else ""))
+
+    def _start_clock(self) -> bool:
+        """Measure the Target's HF and LF clocks when enabled; False when skipped."""
+        if self._clock_done or not self.chk_clock.isChecked() or not self._both_have(FEAT_CLOCK):
+            return False
+        if not self.target_reader or not self.master_reader:
+            return False
+        self._clock_done = True
+        if not self._line_in_run(1):
+            self._log_info("Clock: skipped — its test line is not tested")
+            return False
+        self._clock_results.clear()
+        self._clock_queue = ["HF", "LF"]
+        self._stage_awaited("clock")
+        self._clock_next()
+        return True
+
+    def _clock_next(self):
+        if not self._clock_queue:
+            self._clock_queue = None
+            if self.target_reader: self.target_reader.send_line("CLOCK STOP")
+            return
+        if self.target_reader: self.target_reader.send_line(f"CLOCK {self._clock_queue.pop(0)}")
+
+    def _on_clock_line(self, role: str, line: str):
+        """Pace the clock stage: Target CLOCK_UP -> Master CLOCK -> next clock -> CLOCK_DONE."""
+        uline = line.upper()
+        (self.master_log if role == "master" else self.target_log).appendPlainText(line)
+        parts = line.split()
+        if role == "target":
+            if "CLOCK_UP" in uline and len(parts) >= 3:
+                if len(parts) > 3:
+                    self._clock_results["LF_SRC"] = parts[3].partition("=")[2]
+                if self.master_reader: self.master_reader.send_line(f"CLOCK {parts[2]}")
+            elif "CLOCK_REJECTED" in uline:
+                self._clock_next()
+            elif "CLOCK_DONE" in uline:
+                self._stage_finished("clock")
+                self._log_clock_summary()
+                self._advance_pre_sequence()
+            return
+        if len(parts) < 4 or parts[2].upper() == "BUSY":
+            self._clock_queue = []  # Master cannot measure now: stop the Target and go on
+        else:
+            kv = dict(t.split("=", 1) for t in parts[3:] if "=" in t)
+            self._clock_results[parts[2].upper()] = kv.get("ppm", "no signal")
+        if self._clock_queue is not None:
+            self._clock_next()
+
+    def _log_clock_summary(self):
+        src = self._clock_results.get("LF_SRC")
+        parts = [f"{name} {self._clock_results[name]}" + ("" if self._clock_results[name] == "no signal" else " ppm")
+                 for name in ("HF", "LF") if name in self._clock_results]
+        self._log_info("Clock: " + ", ".join(parts) + (f" (LF source {src})" if src else ""))
+
+    def _start_vcc(self) -> bool:
+        """Time the Target's VCC switch when enabled; False when skipped."""
+        if self._vcc_done or not self.chk_vcc.isChecked() or not self._both_have(FEAT_VCC):
+            return False
+        if not self.target_reader or not self.master_reader:
+            return False
+        self._vcc_done = True
+        if not (self._line_in_run(0) and self._line_in_run(1)):
+            self._log_info("VCC: skipped — the VCC or step marker line is not tested")
+            return False
+        self._vcc_running = True
+        self._stage_awaited("vcc")
+        self.master_reader.send_line("VCC")  # the Master arms its captures first
+        return True
+
+    def _on_vcc_line(self, role: str, line: str):
+        """Pace the VCC stage: Master VCC ARMED -> Target VCC CYCLE -> Master VCC result."""
+        (self.master_log if role == "master" else self.target_log).appendPlainText(line)
+        if role == "target":
+            return  # VCC_DONE / VCC_REJECTED: the Master's result (or NO SIGNAL) follows
+        if "ARMED" in line.upper():
+            if self.target_reader: self.target_reader.send_line("VCC CYCLE")
+            return
+        if not self._vcc_running:
+            return
+        self._vcc_running = False
+        self._stage_finished("vcc")
+        kv = dict(t.split("=", 1) for t in line.split()[2:] if "=" in t)
+        for stat in ("off_us", "on_us"):
+            try:
+                self._vcc_values[stat] = float(kv[stat])
+            except (KeyError, ValueError):
+                pass  # "-": no transition
+        if "off_us" in kv:
+            self._log_info(f"VCC: off {kv['off_us']} us (limit {kv.get('limit_off_us', '?')}), "
+                           f"on {kv.get('on_us', '-')} us (limit {kv.get('limit_on_us', '?')}), "
+                           f"{kv.get('dropouts', '?')} dropouts")
+        self._advance_pre_sequence()
+
+    # --- Session watchdog (session_watchdog.py) ---
+    def _poll_watchdog(self):
+        """Take the recovery step of a stalled run: resend, re-INIT, reset the Target, reopen the ports."""
+        stage = self._watchdog.current_stage
+        pending = self._watchdog.pending()
+        step = self._watchdog.poll(time.monotonic())
+        if step is None:
+            return
+        if step == GIVE_UP:
+            self._log_info(f"Watchdog: {stage} stalled after every recovery step — run aborted, check the cables")
+            self._abort_run()
+            return
+        metrics.RECOVERIES.inc(step)
+        if step == "resend":
+            for role, line in pending:
+                reader = self.master_reader if role == "master" else self.target_reader
+                if reader:
+                    reader.send_line(line)
+            detail = "resent " + ", ".join(f"{role} {line}" for role, line in pending)
+        elif step == "reinit":
+            self._reinit_boards()
+            detail = "INIT both boards"
+        elif step == "reset_target":
+            if self.master_reader:
+                self.master_reader.send_line("RESET_TARGET")
+            self._reinit_boards()
+            detail = "Target reset by the Master"
+        else:
+            self.restart_readers()
+            self._reinit_boards()
+            detail = "serial ports reopened"
+        self._log_info(f"Watchdog: {stage} stalled — {detail} (recoveries: {self._watchdog.summary()})")
+
+    def _reinit_boards(self):
+        """Start the run over: both READY lines request START again (_last_action is kept)."""
+        self._master_ready = False
+        self._target_ready = False
+        self._id_wait = 0
+        self._watchdog.restart(time.monotonic())
+        for reader in (self.master_reader, self.target_reader):
+            if reader:
+                reader.send_line("INIT")
+
+    def _abort_run(self):
+        """End a run the watchdog could not recover: no verdict, nothing recorded per board."""
+        if self._run_started is not None:
+            metrics.record_run("error", time.monotonic() - self._run_started)
+        self._run_started = None
+        self._stop_watchdog()
+        self._finish_trace()
+        self._finish_capture()
+        self.set_failure_state()
+        self._set_btn_state(self.btn_run, "error")
+        if self._last_action == "flash_run":
+            self._set_btn_state(self.btn_flash_run, "error")
+        self._last_action = None
+
+    def _stop_watchdog(self):
+        self._watchdog.disarm()
+        self._watchdog_timer.stop()
+
+    # --- Live contact monitor (Master MONITOR ON, Target HOLD) ---
+    def on_monitor_toggled(self, on: bool):
+        if on:
+            if not self.master_reader or not self.target_reader or not self._both_have(FEAT_MONITOR):
+                self._log_info("Monitor: connect both boards with monitor firmware first")
+                self._set_monitor_checked(False)
+                return
+            profile = PROFILES.get(self._desc["master"].profile or DEFAULT_PROFILE.name, DEFAULT_PROFILE)
+            self._mon_pins = [pin_id(label) for label in profile.labels]
+            self._mon_levels = 0
+            self._mon_low_seen = 0
+            self._mon_changes = 0
+            self._mon_last_us = 0
+            self.pinout_view.set_not_tested(self._excluded_pins)
+            self.pinout_view.set_circles_idle()
+            # Every tested line HIGH: a pin that reads LOW has lost contact. Excluded
+            # pads stay LOW, as in ALL_HIGH: they may be wired to something else.
+            hold = sum(1 << i for i, pin in enumerate(self._mon_pins) if pin not in self._excluded_pins)
+            self.target_reader.send_line(f"HOLD {hold:X}")
+            self.master_reader.send_line("MONITOR ON")
+            self._mon_paint.start()
+        else:
+            self._mon_paint.stop()
+            if self.master_reader:
+                self.master_reader.send_line("MONITOR OFF")
+            if self.target_reader:
+                self.target_reader.send_line("HOLD 0")
+            self.pinout_view.set_circles_idle()
+
+    def _set_monitor_checked(self, on: bool):
+        """Reflect a monitor the Master ended (button, START, BUSY) without sending commands."""
+        self._mon_paint.stop()
+        self.btn_monitor.blockSignals(True)
+        self.btn_monitor.setChecked(on)
+        self.btn_monitor.blockSignals(False)
+
+    def _on_monitor_line(self, line: str):
+        """'Master: MON <us> <hex>' (a change, or the 1 s refresh) and the MONITOR ON/OFF/BUSY replies."""
+        parts = line.split()
+        if parts[1].upper() == "MON" and len(parts) == 4:
+            try:
+                t_us, levels = int(parts[2]), int(parts[3], 16)
+            except ValueError:
+                return
+            if levels != self._mon_levels and self._mon_last_us:
+                self._mon_changes += 1
+            self._mon_levels = levels
+            self._mon_low_seen |= ~levels
+            self._mon_last_us = t_us
+            return
+        self.master_log.appendPlainText(line)
+        state = parts[2].upper() if len(parts) > 2 else ""
+        if state == "OFF" or state == "BUSY":
+            if self.btn_monitor.isChecked():
+                self._set_monitor_checked(False)
+                if self.target_reader:
+                    self.target_reader.send_line("HOLD 0")
+            if state == "OFF" and self._mon_last_us:
+                self._log_info(f"Monitor: {self._mon_changes} contact changes in {self._mon_last_us / 1e6:.1f} s")
+            elif state == "BUSY":
+                self._log_info("Monitor: the Master is running a test")
+
+    def _paint_monitor(self):
+        low = self._mon_low_seen
+        self._mon_low_seen = ~self._mon_levels
+        states = {}
+        excluded = self._excluded_pins
+        for i, pin in enumerate(self._mon_pins):
+            if pin is not None and pin not in excluded:
+                states[pin] = PinoutView.FAIL if low & (1 << i) else PinoutView.OK
+        self.pinout_view.set_pin_states(states, PinoutView.IDLE)
+
+    def _on_pin_verdict(self, failed: bool):
+        """Paced run: queue the next Target pin as soon as the Master has judged this one."""
+        if not self._paced or self._pin_outstanding is None:
+            return
+        self._pin_outstanding = None
+        if self._pins_sent >= self._run_pin_count():
+            return
+        if failed and self.mode_combo.currentData() == "FAST":
+            return
+        self._send_target_next_pin()
+
+    # --- Timeline trace ---
+    def on_trace_toggled(self, checked: bool):
+        QSettings("aroum", "C!N Tester GUI").setValue("trace_runs", checked)
+        if not checked:
+            for reader in (self.master_reader, self.target_reader):
+                if reader:
+                    reader.send_line("TRACE OFF")
+
+    def _serial_tap(self, role: str, direction: str, line: str, t_ns: int):
+        """SerialReader tap, runs in the reader thread."""
+        trace = self._trace
+        if trace is not None:
+            trace.on_serial_traffic(role, direction, line, t_ns)
+        capture = self._capture
+        if capture is not None:
+            capture.tap(role, direction, line, t_ns)
+        if direction == "tx":
+            self._watchdog.sent(role, line)
+
+    def _start_trace(self):
+        """Start a trace for the new run: enable firmware events and sync both clocks."""
+        if not self.btn_trace.isChecked():
+            self._trace = None
+            return
+        self._trace = RunTrace()
+        self._trace.begin_sync_burst()
+        for reader in (self.master_reader, self.target_reader):
+            if reader:
+                reader.tap = self._serial_tap
+                reader.send_line("TRACE ON")
+                for _ in range(4):
+                    reader.send_line("TIMESYNC")
+
+    def _finish_trace(self):
+        """Re-sync the clocks at the end of the run, then write the trace file."""
+        trace = self._trace
+        if trace is None:
+            return
+        self._trace = None
+        trace.begin_sync_burst()
+        for reader in (self.master_reader, self.target_reader):
+            if reader:
+                reader.tap = trace.on_serial_traffic  # keep feeding this trace until written
+                for _ in range(2):
+                    reader.send_line("TIMESYNC")
+        deadline = time.monotonic() + 1.0
+
+        def write():
+            if not trace.sync_complete() and time.monotonic() < deadline:
+                QTimer.singleShot(50, write)
+                return
+            for reader in (self.master_reader, self.target_reader):
+                if reader and reader.tap == trace.on_serial_traffic:
+                    reader.tap = self._serial_tap
+            path = os.path.join(traces_dir(), time.strftime("run_%Y%m%d_%H%M%S.json"))
+            try:
+                trace.write_chrome_json(path)
+                self._log_info(f"Trace: saved {path}")
+            except Exception as e:
+                self._log_info(f"Trace: error — {e}")
+
+        QTimer.singleShot(50, write)
+
+    # --- Serial capture / replay ---
+    def _start_capture(self):
+        """Record the serial traffic of the new run (writes happen in the capture's own thread)."""
+        self._finish_capture()
+        if not self.btn_capture.isChecked() or self._replaying:
+            return
+        path = os.path.join(traces_dir(), time.strftime("run_%Y%m%d_%H%M%S.cncap"))
+        try:
+            capture = CaptureWriter(path)
+        except Exception as e:
+            self._log_info(f"Capture: error — {e}")
+            return
+        for role in ("master", "target"):
+            if role in self._desc_lines:
+                capture.add_context(role, self._desc_lines[role])
+        self._capture = capture
+
+    def _finish_capture(self):
+        capture = self._capture
+        if capture is None:
+            return
+        self._capture = None
+        capture.close()
+        self._log_info(f"Capture: saved {capture.path}")
+
+    def attach_replay_ports(self, master, target):
+        """Replace the serial readers with replay stand-ins (see serial_capture.CaptureReplay)."""
+        self._replaying = True
+        if self.port_watcher.isRunning():
+            self.port_watcher.stop()
+        for role, port in (("master", master), ("target", target)):
+            reader = getattr(self, f"{role}_reader")
+            if reader:
+                try:
+                    reader.line_received.disconnect(self.on_serial_line)
+                except Exception:
+                    pass
+                reader.stop()
+                reader.wait(500)
+            setattr(self, f"{role}_reader", port)
+
     def _list_ports(self) -> set[str]:
         """Return a set of currently available COM devices, e.g. {"COM3", "COM7"}."""
         try:
@@ -916,7 +2205,15 @@ class MainWindow(QWidget):
                 pass
 
     def on_run_test(self):
+        if self.btn_monitor.isChecked():
+            self.btn_monitor.setChecked(False)  # INIT and the stages take the pins back
+        self._run_started = time.monotonic()
+        self._stage_t0.clear()
         self.problem_pins.clear()
+        self._pin_samples.clear()
+        self._board = None
+        self._board_note = None
+        self._id_wait = 0
         self.set_testing_state()
         self.clear_logs()
         
@@ -935,6 +2232,13 @@ class MainWindow(QWidget):
         except Exception:
             pass
 
+        self._start_trace()
+        self._start_capture()
+        if not self._replaying:
+            master = self._desc["master"]
+            self._watchdog.arm(self._run_started, reset_target=master is not None and master.has(FEAT_RECOVERY))
+            self._watchdog_timer.start()
+
         # Send INIT to both to synchronize
         if self.master_reader:
             self.master_reader.send_line("INIT")
@@ -1041,6 +2345,10 @@ class MainWindow(QWidget):
             self.btn_auto_search.setText("Auto Search")
 
     def restart_readers(self):
+        if self._replaying:
+            return
+        self._desc = {"master": None, "target": None}
+        self._desc_lines.clear()
         # stop existing
         for role in ("master", "target"):
             reader = getattr(self, f"{role}_reader")
@@ -1069,6 +2377,7 @@ class MainWindow(QWidget):
         if not dev or dev.startswith("<"):
             return
         reader = SerialReader(dev, role)
+        reader.tap = self._serial_tap
         reader.line_received.connect(self.on_serial_line)
         reader.start()
         setattr(self, f"{role}_reader", reader)
@@ -1081,11 +2390,20 @@ class MainWindow(QWidget):
         return pins
 
     def on_serial_line(self, role: str, line: str):
+        t0 = time.monotonic_ns()
+        self._watchdog.heard(role, line, t0 / 1e9)
+        self._handle_serial_line(role, line)
+        trace = self._trace
+        if trace is not None:
+            trace.host_span("on_serial_line", t0, time.monotonic_ns(), args={"role": role, "line": line})
+
+    def _handle_serial_line(self, role: str, line: str):
         uline = line.upper()
         # Validate message source
         if role == "master":
             if "Hello! I am Master!" in line:
                 self._master_ready = False
+                self._desc["master"] = None
                 self.box_master_ready.set_color(QColor(255, 0, 0)) # reset to red
                 if self.master_reader:
                     self.master_reader.send_line("INIT")
@@ -1096,6 +2414,7 @@ class MainWindow(QWidget):
         elif role == "target":
             if "Hello! I am Target!" in line:
                 self._target_ready = False
+                self._desc["target"] = None
                 self.box_target_ready.set_color(QColor(255, 0, 0)) # reset to red
                 if self.target_reader:
                     self.target_reader.send_line("INIT")
@@ -1113,18 +2432,73 @@ class MainWindow(QWidget):
         else:
             return
 
+        # Timeline trace lines are consumed by the SerialReader tap
+        if uline.startswith(("MASTER: TRACE", "TARGET: TRACE", "MASTER: TIMESYNC", "TARGET: TIMESYNC")):
+            return
+
+        # Result journal download (JOURNAL?): collected, not logged line by line
+        if role == "master" and uline.startswith(("MASTER: JOURNAL", "MASTER: JREC ", "MASTER: JPIN ")):
+            self._on_journal_line(line)
+            return
+
+        # Informational replies (MEM, AUTOSTART): log them only
+        if uline.startswith(("MASTER: MEM ", "TARGET: MEM ", "MASTER: AUTOSTART")):
+            (self.master_log if role == "master" else self.target_log).appendPlainText(line)
+            return
+
+        # Live contact monitor: MON samples repaint the pinout, they are not logged
+        if role == "master" and uline.startswith(("MASTER: MON ", "MASTER: MONITOR ")):
+            self._on_monitor_line(line)
+            return
+        if role == "target" and uline.startswith(("TARGET: HOLD", "TARGET: HOLD_REJECTED")):
+            self.target_log.appendPlainText(line)
+            return
+
+        # Board identity (answer to ID?)
+        if role == "target" and uline.startswith("TARGET: ID "):
+            self.target_log.appendPlainText(line)
+            self._on_identity(line)
+            return
+
+        # Capability descriptor (answer to HELLO?)
+        if uline.startswith(("MASTER: DESC ", "TARGET: DESC ")):
+            (self.master_log if role == "master" else self.target_log).appendPlainText(line)
+            self._on_descriptor(role, line)
+            return
+
+        # Crosstalk sweep and clock stage replies pace each other; never taken for stage or FAIL lines
+        if uline.startswith(("MASTER: XTALK", "TARGET: XTALK")):
+            self._on_xtalk_line(role, line)
+            return
+        if uline.startswith(("MASTER: CLOCK", "TARGET: CLOCK")):
+            self._on_clock_line(role, line)
+            return
+        if uline.startswith(("MASTER: VCC", "TARGET: VCC")):
+            self._on_vcc_line(role, line)
+            return
+
+        # Run verdict with mode and defect map; the FAIL/SUCCESS line that follows drives the UI
+        if uline.startswith("MASTER: RESULT "):
+            self._on_run_result(line)
+            return
+
         if "READY" in uline:
             if role == "master":
                 self._master_ready = True
                 self.box_master_ready.set_color(QColor(0, 200, 0))
+                if self.master_reader:
+                    self.master_reader.send_line(f"AUTOSTART {self._auto_start_stable_ms()}")
             elif role == "target":
                 self._target_ready = True
                 self.box_target_ready.set_color(QColor(0, 200, 0))
+            # Ask once per connection; firmware without HELLO? stays silent (legacy pacing)
+            reader = self.master_reader if role == "master" else self.target_reader
+            if reader and self._desc[role] is None:
+                reader.send_line("HELLO?")
             
             if self._master_ready and self._target_ready:
                 if getattr(self, "_last_action", "") in ("run", "flash_run"):
-                    if self.master_reader:
-                        self.master_reader.send_line("START")
+                    self._request_start()
             return
 
         # READY indicator and logging with suppression of repeated 'STAGE — IDLE: OK'
@@ -1151,25 +2525,68 @@ class MainWindow(QWidget):
         except Exception:
             pass
 
-        # Only the master controls test states
+        # Only the master controls test states; Target acks pace the Master in paced runs
         if role != "master":
+            if self._paced:
+                self._on_target_ack(uline)
             return
 
         if "BUTTON_PRESSED" in uline:
             self.on_run_test()
             return
 
+        if "TARGET_SEATED" in uline:
+            # Contacts stable on a newly seated Target; USB enumeration may already be starting the run
+            if self.chk_auto_start.isChecked() and not self._run_in_progress() and not self._await_target_ready:
+                self.on_run_test()
+            return
+
+        if "START REJECTED" in uline:
+            self._start_rejected()
+            return
+
+        if uline.startswith("MASTER: START COMMAND RECEIVED"):
+            return  # the ack of START; the run starts with the 'Master: START' line that follows
+
         if "START" in uline:
             # Only react if test was initiated from UI or physical button
             if getattr(self, "_last_action", "") not in ("run", "flash_run"):
                 # If it was button press, we set action to run
                 self._last_action = "run"
             
+            self._paced = self._paced_supported()
+            self._pin_outstanding = None
+            self._pins_sent = 0
+            self._xtalk_queue = None
+            self._xtalk_done = False
+            self._clock_queue = None
+            self._clock_done = False
+            self._vcc_running = False
+            self._vcc_done = False
             self.problem_pins.clear()
+            self._pin_samples.clear()
+            self._vcc_values.clear()
+            self._golden_deviations = []
+            self.pinout_view.set_not_tested(self._untested_pins() | self._excluded_pins)
             self.set_testing_state()
             self.pinout_view.set_circles_testing()
             # Clear logs when the test actually begins
             self.clear_logs()
+            self._last_result = {}
+            if self._board_note is not None:
+                self._log_info(self._board_note)
+                self._board_note = None
+            else:
+                # Started without the ID? gate (button, auto start): identify the board now
+                self._board = None
+                target = self._desc["target"]
+                if target is not None and target.has(FEAT_ID) and self.target_reader and not self._replaying:
+                    self.target_reader.send_line("ID?")
+            if self._retest_note is not None:
+                self._log_info(self._retest_note)
+                self._retest_note = None
+            if self._watchdog.run_steps:
+                self._log_info(f"Watchdog: run restarted after {', '.join(self._watchdog.run_steps)}")
             return
         palette = QApplication.palette()
         base_color = palette.color(QPalette.Base)
@@ -1178,13 +2595,16 @@ class MainWindow(QWidget):
         # stage updates
         if "ALL_HIGH" in uline:
             if "AWAIT" in uline:
-                if self.master_reader: self.master_reader.send_line("START_ALL_HIGH")
-                if self.target_reader: self.target_reader.send_line("START_ALL_HIGH")
+                self._stage_awaited("all_high")
+                if self.master_reader and not self._paced: self.master_reader.send_line(self._stage_command("START_ALL_HIGH"))
+                if self.target_reader: self.target_reader.send_line(self._stage_command("START_ALL_HIGH"))
             elif "BEGIN" in uline:
                 self.box_all_high.set_color(QColor(255, 255, 0))
             elif "OK" in uline:
+                self._stage_finished("all_high")
                 self.box_all_high.set_color(QColor(0, 200, 0))
             elif "ERROR" in uline:
+                self._stage_finished("all_high")
                 self.box_all_high.set_color(QColor(255, 0, 0))
                 self.problem_pins |= self._extract_pins_from_message(line)
                 # Buttons per spec on test error
@@ -1204,13 +2624,16 @@ class MainWindow(QWidget):
 
         if "ALL_LOW" in uline:
             if "AWAIT" in uline:
-                if self.master_reader: self.master_reader.send_line("START_ALL_LOW")
-                if self.target_reader: self.target_reader.send_line("START_ALL_LOW")
+                self._stage_awaited("all_low")
+                if self.master_reader and not self._paced: self.master_reader.send_line(self._stage_command("START_ALL_LOW"))
+                if self.target_reader: self.target_reader.send_line(self._stage_command("START_ALL_LOW"))
             elif "BEGIN" in uline:
                 self.box_all_low.set_color(QColor(255, 255, 0))
             elif "OK" in uline:
+                self._stage_finished("all_low")
                 self.box_all_low.set_color(QColor(0, 200, 0))
             elif "ERROR" in uline:
+                self._stage_finished("all_low")
                 self.box_all_low.set_color(QColor(255, 0, 0))
                 self.problem_pins |= self._extract_pins_from_message(line)
                 # Buttons per spec on test error
@@ -1229,18 +2652,35 @@ class MainWindow(QWidget):
 
         if "SEQUENCE" in uline:
             if "AWAIT_PIN" in uline:
-                if self.master_reader: self.master_reader.send_line("NEXT_PIN")
-                if self.target_reader: self.target_reader.send_line("NEXT_PIN")
+                self._stage_awaited("pin")
+                if not self._paced:
+                    if self.master_reader: self.master_reader.send_line("NEXT_PIN")
+                    if self.target_reader: self.target_reader.send_line("NEXT_PIN")
+                elif self._pin_outstanding is None:
+                    self._send_target_next_pin()
+                elif time.monotonic() - self._pin_outstanding > 2.0:
+                    # Target ack lost: let the Master time the pin out on its own
+                    if self.master_reader: self.master_reader.send_line("NEXT_PIN")
             elif "AWAIT" in uline:
-                if self.master_reader: self.master_reader.send_line("START_SEQUENCE")
-                if self.target_reader: self.target_reader.send_line("START_SEQUENCE")
+                self._advance_pre_sequence()
             elif "BEGIN" in uline:
                 self.box_sequence.set_color(QColor(255, 255, 0))
             elif "ALL OK" in uline or ("OK" in uline and "ALL" in uline):
+                self._stage_finished("sequence")
                 self.box_sequence.set_color(QColor(0, 200, 0))
+            elif "OK" in uline:
+                self._on_pin_ok(line)
+                self._stage_finished("pin")
+                self._on_pin_verdict(failed=False)
             elif "ERROR" in uline:
+                # One failed pin; FULL and RETEST runs go on with the next one, so the
+                # sequence stage ends on ALL OK or the verdict
+                self._stage_finished("pin")
+                self._on_pin_verdict(failed=True)
                 self.box_sequence.set_color(QColor(255, 0, 0))
                 self.problem_pins |= self._extract_pins_from_message(line)
+                if self.mode_combo.currentData() != "FAST":
+                    return  # buttons turn red with the verdict
                 # Buttons per spec on test error
                 if getattr(self, "_last_action", "") == "run":
                     try:
@@ -1255,7 +2695,11 @@ class MainWindow(QWidget):
                         pass
             return
 
-        if "SUCCESS" in uline:
+        # A run the Master passed still fails when it is off the golden signature
+        if "SUCCESS" in uline and not self._golden_deviations:
+            self._finish_trace()
+            self._finish_capture()
+            self._run_finished("pass")
             self.set_success_state()
             self.pinout_view.set_circles_success(self.problem_pins)
             try:
@@ -1271,7 +2715,11 @@ class MainWindow(QWidget):
                 pass
             return
 
-        if "FAIL" in uline or "ERROR" in uline:
+        if "FAIL" in uline or "ERROR" in uline or "SUCCESS" in uline:
+            self._stage_finished("sequence")
+            self._finish_trace()
+            self._finish_capture()
+            self._run_finished("fail")
             self.set_failure_state()
             self.pinout_view.set_circles_failure(self.problem_pins)
             # Buttons per spec on failure
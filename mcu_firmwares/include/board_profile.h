@@ -0,0 +1,98 @@
+/**
+ * Board profiles: the test harness of each ProMicro-like SKU, fixed at
+ * compile time. One PlatformIO env per profile selects it with
+ * -DBOARD_PROFILE_<NAME>; without a flag the SUPERMINI profile is used.
+ *
+ * A profile provides, in test order:
+ *   NAME        reported in the HELLO? descriptor (profile=<name>)
+ *   TargetPins  PinGroup the Target drives; its first pin is VccCtrl
+ *   MasterPins  PinGroup the Master reads, wired to TargetPins one to one
+ *   VccCtrl     Target pin that switches the external power
+ *   LABELS      console and GUI labels
+ * Everything derived from it (group masks, NUM_TEST_PINS, PIN_MAP_HASH) is
+ * constexpr, so each binary stays specialized and carries no runtime tables
+ * beyond the labels it prints.
+ *
+ * Adding a SKU: add a struct below, a #elif for its flag, an env in both
+ * platformio.ini files and its labels/pinout in app/board_profiles.py.
+ */
+#pragma once
+
+#include "fast_gpio.h"
+
+namespace board {
+
+using fastgpio::Pin;
+using fastgpio::PinGroup;
+
+// nice!nano / SuperMini: 18 edge pins plus the switched VCC
+struct SuperMini {
+  static constexpr const char *NAME = "supermini";
+  using VccCtrl = Pin<0, 13>;
+  using TargetPins = PinGroup<VccCtrl, Pin<0, 31>, Pin<0, 29>, Pin<0, 2>, Pin<1, 15>, Pin<1, 13>,
+                              Pin<1, 11>, Pin<0, 10>, Pin<0, 9>, Pin<1, 6>, Pin<1, 4>, Pin<0, 11>,
+                              Pin<1, 0>, Pin<0, 24>, Pin<0, 22>, Pin<0, 20>, Pin<0, 17>, Pin<0, 8>,
+                              Pin<0, 6>>;
+  // The Master senses the Target VCC on P1_07; the other lines use the same pins
+  using MasterPins = PinGroup<Pin<1, 7>, Pin<0, 31>, Pin<0, 29>, Pin<0, 2>, Pin<1, 15>, Pin<1, 13>,
+                              Pin<1, 11>, Pin<0, 10>, Pin<0, 9>, Pin<1, 6>, Pin<1, 4>, Pin<0, 11>,
+                              Pin<1, 0>, Pin<0, 24>, Pin<0, 22>, Pin<0, 20>, Pin<0, 17>, Pin<0, 8>,
+                              Pin<0, 6>>;
+  static constexpr const char *LABELS[] = {"P0_13(VCC)", "P0_31", "P0_29", "P0_02", "P1_15",
+                                           "P1_13",      "P1_11", "P0_10", "P0_09", "P1_06",
+                                           "P1_04",      "P0_11", "P1_00", "P0_24", "P0_22",
+                                           "P0_20",      "P0_17", "P0_08", "P0_06"};
+};
+
+// Clones with the P1_01, P1_02 and P1_07 pads on the back. The Master uses
+// those pins itself (reset, button, VCC sense), so the fixture routes the
+// extra pads to Master P0_04, P0_05 and P0_26.
+struct SuperMiniExt {
+  static constexpr const char *NAME = "supermini_ext";
+  using VccCtrl = Pin<0, 13>;
+  using TargetPins = PinGroup<VccCtrl, Pin<0, 31>, Pin<0, 29>, Pin<0, 2>, Pin<1, 15>, Pin<1, 13>,
+                              Pin<1, 11>, Pin<0, 10>, Pin<0, 9>, Pin<1, 6>, Pin<1, 4>, Pin<0, 11>,
+                              Pin<1, 0>, Pin<0, 24>, Pin<0, 22>, Pin<0, 20>, Pin<0, 17>, Pin<0, 8>,
+                              Pin<0, 6>, Pin<1, 1>, Pin<1, 2>, Pin<1, 7>>;
+  using MasterPins = PinGroup<Pin<1, 7>, Pin<0, 31>, Pin<0, 29>, Pin<0, 2>, Pin<1, 15>, Pin<1, 13>,
+                              Pin<1, 11>, Pin<0, 10>, Pin<0, 9>, Pin<1, 6>, Pin<1, 4>, Pin<0, 11>,
+                              Pin<1, 0>, Pin<0, 24>, Pin<0, 22>, Pin<0, 20>, Pin<0, 17>, Pin<0, 8>,
+                              Pin<0, 6>, Pin<0, 4>, Pin<0, 5>, Pin<0, 26>>;
+  static constexpr const char *LABELS[] = {
+      "P0_13(VCC)", "P0_31", "P0_29", "P0_02", "P1_15", "P1_13", "P1_11", "P0_10",
+      "P0_09",      "P1_06", "P1_04", "P0_11", "P1_00", "P0_24", "P0_22", "P0_20",
+      "P0_17",      "P0_08", "P0_06", "P1_01", "P1_02", "P1_07"};
+};
+
+#if defined(BOARD_PROFILE_SUPERMINI_EXT)
+using Profile = SuperMiniExt;
+#else
+using Profile = SuperMini;
+#endif
+
+static_assert(Profile::TargetPins::size == Profile::MasterPins::size,
+              "Master and Target groups must wire one to one");
+static_assert(sizeof(Profile::LABELS) / sizeof(Profile::LABELS[0]) == Profile::TargetPins::size,
+              "one label per test pin");
+
+// FNV-1a over the comma-joined labels: identifies the pin map and order
+// (app/descriptor.py pin_map_hash computes the same value)
+constexpr uint32_t pinMapHash(const char *const *labels, size_t n) {
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < n; i++) {
+    if (i) {
+      h ^= (uint8_t)',';
+      h *= 16777619UL;
+    }
+    for (const char *p = labels[i]; *p; p++) {
+      h ^= (uint8_t)*p;
+      h *= 16777619UL;
+    }
+  }
+  return h;
+}
+
+constexpr int NUM_TEST_PINS = Profile::TargetPins::size;
+constexpr uint32_t PIN_MAP_HASH = pinMapHash(Profile::LABELS, NUM_TEST_PINS);
+
+} // namespace board
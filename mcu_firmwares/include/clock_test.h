@@ -0,0 +1,57 @@
+/**
+ * Clock accuracy stage (CLOCK HF|LF), shared by both firmwares.
+ *
+ * The Target outputs a square wave on test line PIN_INDEX, timed by one of
+ * its clocks without the CPU:
+ *
+ *   HF   TIMER2 on the 16 MHz HFXO        HF_HZ
+ *   LF   RTC2 TICK on the 32.768 kHz LFCLK LF_HZ
+ *
+ * The Master counts the rising edges (GPIOTE -> PPI -> TIMER4 in counter
+ * mode) and captures its own HFXO-timed TIMER3 at the first edge and CYCLES
+ * edges later, so the period is measured in hardware over the whole window.
+ * The result is relative to the Master's crystal and includes its error.
+ */
+#pragma once
+
+#include <nrf.h>
+#include <stdint.h>
+
+namespace clocktest {
+
+const int PIN_INDEX = 1; // first test line after VCC (TestPins order)
+
+const uint32_t TIMER_HZ = 16000000; // TIMER with PRESCALER 0
+const uint32_t LFCLK_HZ = 32768;
+
+const uint32_t HF_HZ = 10000;
+const uint32_t HF_CYCLES = 1000; // 100 ms
+const uint32_t LF_HZ = 16384;
+const uint32_t LF_CYCLES = 1600; // 97.7 ms
+
+// Target: TIMER2 CC[0] for one HF_HZ half period
+constexpr uint32_t hfHalfPeriodTicks() { return TIMER_HZ / HF_HZ / 2; }
+
+// Target: RTC2 PRESCALER for a TICK every LF_HZ half period
+constexpr uint32_t lfPrescaler() { return LFCLK_HZ / (2 * LF_HZ) - 1; }
+
+// Master: TIMER3 ticks for `cycles` periods of an exact `hz` signal
+constexpr uint32_t expectedTicks(uint32_t hz, uint32_t cycles) {
+  return (uint32_t)((uint64_t)cycles * TIMER_HZ / hz);
+}
+
+static_assert(TIMER_HZ % (2 * HF_HZ) == 0, "HF half period in whole TIMER ticks");
+static_assert(LFCLK_HZ % (2 * LF_HZ) == 0, "LF half period in whole RTC ticks");
+
+// Run HFCLK from the crystal (the default HFINT RC is only +-1.5 %).
+// Start-up takes well under a millisecond; the crystal then stays on.
+inline void startHfxo() {
+  if (NRF_CLOCK->HFCLKSTAT & CLOCK_HFCLKSTAT_SRC_Msk)
+    return;
+  NRF_CLOCK->EVENTS_HFCLKSTARTED = 0;
+  NRF_CLOCK->TASKS_HFCLKSTART = 1;
+  while (!NRF_CLOCK->EVENTS_HFCLKSTARTED) {
+  }
+}
+
+} // namespace clocktest
@@ -0,0 +1,135 @@
+/**
+ * Compile-time GPIO for the nRF52840 (header-only, shared by both firmwares).
+ *
+ * A pin is a type, Pin<Port, Index>, and a pin group is a type list,
+ * PinGroup<Pins...>. Port masks are folded at compile time, so a group write
+ * is one OUTSET/OUTCLR store per port and a group read is one IN load per
+ * port. Nothing goes through g_ADigitalPinMap or a pin loop at runtime.
+ *
+ * Pin numbers follow the nicenano variant: P0.xx = xx, P1.xx = 32 + xx.
+ */
+#pragma once
+
+#include <nrf.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+namespace fastgpio {
+
+// PIN_CNF values; inputs stay connected on outputs so read() sees the pad
+enum Mode : uint32_t {
+  Input = GPIO_PIN_CNF_PULL_Disabled << GPIO_PIN_CNF_PULL_Pos,
+  InputPulldown = GPIO_PIN_CNF_PULL_Pulldown << GPIO_PIN_CNF_PULL_Pos,
+  InputPullup = GPIO_PIN_CNF_PULL_Pullup << GPIO_PIN_CNF_PULL_Pos,
+  Output = (GPIO_PIN_CNF_DIR_Output << GPIO_PIN_CNF_DIR_Pos) |
+           (GPIO_PIN_CNF_DRIVE_S0S1 << GPIO_PIN_CNF_DRIVE_Pos),
+};
+
+// PIN_CNF SENSE: an input at the sensed level sets its bit in the port LATCH
+// register, so pulses shorter than any polling period are still caught
+enum Sense : uint32_t {
+  SenseOff = GPIO_PIN_CNF_SENSE_Disabled << GPIO_PIN_CNF_SENSE_Pos,
+  SenseHigh = GPIO_PIN_CNF_SENSE_High << GPIO_PIN_CNF_SENSE_Pos,
+  SenseLow = GPIO_PIN_CNF_SENSE_Low << GPIO_PIN_CNF_SENSE_Pos,
+};
+
+// Register block of a port; folds to a constant address for a constant port
+inline NRF_GPIO_Type *portReg(uint8_t port) { return port ? NRF_P1 : NRF_P0; }
+
+template <uint8_t Port, uint8_t Index> struct Pin {
+  static_assert(Port <= 1 && Index < (Port ? 16 : 32), "nRF52840 has P0.00-P0.31 and P1.00-P1.15");
+  static constexpr uint8_t port = Port;
+  static constexpr uint8_t index = Index;
+  static constexpr uint32_t mask = 1UL << Index;
+  static constexpr uint8_t number = Port * 32 + Index; // Arduino pin number
+
+  static void mode(Mode m, Sense s = SenseOff) { portReg(Port)->PIN_CNF[Index] = m | s; }
+  static bool read() { return portReg(Port)->IN & mask; }
+  static void high() { portReg(Port)->OUTSET = mask; }
+  static void low() { portReg(Port)->OUTCLR = mask; }
+  static void write(bool level) { level ? high() : low(); }
+  static void toggle() { write(!(portReg(Port)->OUT & mask)); }
+};
+
+// Ordered pin group. Bitmaps use the group order: bit i is the i-th pin.
+template <class... Pins> struct PinGroup {
+  static constexpr size_t size = sizeof...(Pins);
+  static_assert(size > 0 && size <= 32, "group bitmaps hold 1 to 32 pins");
+  static constexpr uint32_t all = size == 32 ? 0xFFFFFFFFUL : (1UL << size) - 1;
+
+  // Port bitmap of the group pins on one port
+  template <uint8_t P> static constexpr uint32_t portMask() {
+    return (0UL | ... | (Pins::port == P ? Pins::mask : 0UL));
+  }
+
+  // Per-index tables for runtime indexing (e.g. one pin of a sequence)
+  static constexpr uint8_t ports[] = {Pins::port...};
+  static constexpr uint32_t masks[] = {Pins::mask...};
+  static constexpr uint8_t numbers[] = {Pins::number...};
+
+  static void mode(Mode m) { (Pins::mode(m), ...); }
+
+  static void write(bool level) {
+    writePort<0>(level);
+    writePort<1>(level);
+  }
+
+  // Bit i set when the i-th pin reads HIGH
+  static uint32_t read() {
+    const uint32_t in0 = portMask<0>() ? NRF_P0->IN : 0;
+    const uint32_t in1 = portMask<1>() ? NRF_P1->IN : 0;
+    return gather(in0, in1, std::index_sequence_for<Pins...>{});
+  }
+
+  static bool anyHigh() {
+    return ((portMask<0>() ? NRF_P0->IN : 0) & portMask<0>()) |
+           ((portMask<1>() ? NRF_P1->IN : 0) & portMask<1>());
+  }
+
+  static void writeAt(size_t i, bool level) {
+    if (level)
+      portReg(ports[i])->OUTSET = masks[i];
+    else
+      portReg(ports[i])->OUTCLR = masks[i];
+  }
+
+  static bool readAt(size_t i) { return portReg(ports[i])->IN & masks[i]; }
+
+  static void modeAt(size_t i, Mode m, Sense s = SenseOff) {
+    portReg(ports[i])->PIN_CNF[numbers[i] & 31] = m | s;
+  }
+
+  // Bit i set when the i-th pin met its Sense level since the last clearLatch()
+  static uint32_t latched() {
+    const uint32_t l0 = portMask<0>() ? NRF_P0->LATCH : 0;
+    const uint32_t l1 = portMask<1>() ? NRF_P1->LATCH : 0;
+    return gather(l0, l1, std::index_sequence_for<Pins...>{});
+  }
+
+  // LATCH bits are write-one-to-clear; a pin still at its Sense level latches again
+  static void clearLatch() {
+    if constexpr (portMask<0>() != 0)
+      NRF_P0->LATCH = portMask<0>();
+    if constexpr (portMask<1>() != 0)
+      NRF_P1->LATCH = portMask<1>();
+  }
+
+private:
+  template <uint8_t P> static void writePort(bool level) {
+    constexpr uint32_t m = portMask<P>();
+    if constexpr (m != 0) {
+      if (level)
+        portReg(P)->OUTSET = m;
+      else
+        portReg(P)->OUTCLR = m;
+    }
+  }
+
+  template <size_t... I>
+  static uint32_t gather(uint32_t in0, uint32_t in1, std::index_sequence<I...>) {
+    return (0UL | ... | ((((Pins::port ? in1 : in0) >> Pins::index) & 1UL) << I));
+  }
+};
+
+} // namespace fastgpio
@@ -0,0 +1,31 @@
+/**
+ * Standalone (PC-less) run timeline, shared by both firmwares.
+ *
+ * Without a USB host the boards cannot exchange stage commands, so the Target
+ * plays a fixed script after boot and the Master samples it on the same
+ * schedule:
+ *
+ *   LEAD_MS          VCC beacon only (the Master detects the seat)
+ *   STAGE_MS         ALL_HIGH  <- sync: two or more lines rise at once
+ *   STAGE_MS         ALL_LOW
+ *   SEQ_MS per pin   SEQUENCE, one pin HIGH at a time in TestPins order
+ *
+ * The Master samples the middle of each slot, so it tolerates the 1 ms sync
+ * poll and the clock difference of the two boards with a wide margin.
+ */
+#pragma once
+
+namespace standalone {
+
+const unsigned long LEAD_MS = 1500;   // longer than the Master seat debounce
+const unsigned long STAGE_MS = 300;   // ALL_HIGH and ALL_LOW hold
+const unsigned long SEQ_MS = 150;     // each SEQUENCE pin
+const unsigned long SEAT_MS = 500;    // Master seat debounce when no host set AUTOSTART
+const unsigned long SYNC_TIMEOUT_MS = 8000; // Target reset, boot and 3 s USB wait
+
+// Offset of a sample point from the sync edge
+constexpr unsigned long allHighSampleMs() { return STAGE_MS / 2; }
+constexpr unsigned long allLowSampleMs() { return STAGE_MS + STAGE_MS / 2; }
+constexpr unsigned long pinSampleMs(int i) { return 2 * STAGE_MS + i * SEQ_MS + SEQ_MS / 2; }
+
+} // namespace standalone
@@ -0,0 +1,44 @@
+/**
+ * VCC switch stage (VCC), shared by both firmwares.
+ *
+ * The Target's VccCtrl pin (test line 0) switches the external power rail
+ * that the Master senses on its VCC line. On `VCC CYCLE` the Target runs a
+ * fixed script and marks each step with an edge on test line REF_INDEX,
+ * written in the same OUTSET/OUTCLR as VccCtrl:
+ *
+ *   all lines HIGH, ref LOW     SETTLE_MS   rail comes up, not measured
+ *   ref HIGH                    WATCH_MS    every line loaded: count dropouts
+ *   ref + VccCtrl LOW           OFF_MS      switch-off transition
+ *   ref + VccCtrl HIGH          ON_MS       switch-on transition
+ *   all lines LOW, VCC_DONE
+ *
+ * The Master timestamps the ref and VCC edges in hardware (GPIOTE -> PPI ->
+ * TIMER3 capture, TIMER4 counts the VCC edges), so a transition time is the
+ * delay from the switch command to the rail crossing the input threshold,
+ * resolved to 1/16 us. The CPU only reads the captures between steps.
+ */
+#pragma once
+
+#include <stdint.h>
+
+namespace vcctest {
+
+const int VCC_INDEX = 0; // VccCtrl on the Target, the VCC sense line on the Master
+const int REF_INDEX = 1; // step marker: first test line after VCC (TestPins order)
+
+const unsigned long SETTLE_MS = 5;
+const unsigned long WATCH_MS = 20;
+const unsigned long OFF_MS = 60; // the rail discharges through the fixture's load
+const unsigned long ON_MS = 10;
+
+// Master verdict limits. The off time depends on the load on the rail (the
+// Master's pull-down at least); the on time is the switch and its soft start.
+const uint32_t OFF_LIMIT_US = 50000;
+const uint32_t ON_LIMIT_US = 2000;
+
+// The Master reads a transition one limit (plus a poll tick) after its ref
+// edge, which must be before the Target's next step
+static_assert(OFF_LIMIT_US / 1000 + 2 < OFF_MS, "off transition read before the switch-on step");
+static_assert(ON_LIMIT_US / 1000 + 2 < ON_MS, "on transition read before the lines go LOW");
+
+} // namespace vcctest
@@ -0,0 +1,261 @@
+#include "journal.h"
+
+#include <InternalFileSystem.h>
+
+using namespace Adafruit_LittleFS_Namespace;
+
+namespace journal {
+
+namespace {
+
+const char *const JOURNAL_PATH = "/journal.bin";
+const char *const OLD_PATH = "/journal.1";
+const char *const COUNTERS_PATH = "/counters.bin";
+const char *const COUNTERS_TMP_PATH = "/counters.tmp";
+
+// Bumped with the record layout: begin() clears a journal of an older one
+const uint32_t JOURNAL_MAGIC = 0x324A4E43;  // "CNJ2"
+const uint32_t COUNTERS_MAGIC = 0x32434E43; // "CNC2"
+const int MAX_PINS = 32;
+const int RECORDS_PER_LINE = 6;
+
+struct __attribute__((packed)) FileHeader {
+  uint32_t magic;
+  uint32_t pinHash;
+  uint8_t recordSize;
+  uint8_t pins;
+  uint16_t reserved;
+};
+static_assert(sizeof(FileHeader) == HEADER_SIZE, "journal file header layout");
+
+// Per-pin defect counts (saturating) and run totals
+struct Counters {
+  uint32_t magic;
+  uint32_t pinHash;
+  uint32_t runs;
+  uint32_t passes;
+  uint16_t high[MAX_PINS];
+  uint16_t low[MAX_PINS];
+  uint16_t seq[MAX_PINS];
+};
+
+bool mounted = false;
+uint32_t pinHash_ = 0;
+int numPins_ = 0;
+Counters counters;
+Record pending[2 * BATCH]; // a full batch waits for idle; the second half absorbs runs meanwhile
+int pendingCount = 0;
+unsigned long lastAddMs = 0;
+uint32_t fileRecords = 0; // records in JOURNAL_PATH
+uint32_t oldRecords = 0;  // records in OLD_PATH
+
+uint8_t crc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0;
+  while (len--) {
+    crc ^= *data++;
+    for (int b = 0; b < 8; b++)
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+void resetCounters() {
+  memset(&counters, 0, sizeof(counters));
+  counters.magic = COUNTERS_MAGIC;
+  counters.pinHash = pinHash_;
+}
+
+// Write a copy and rename it over the old file. LittleFS renames atomically,
+// so a power loss leaves the old or the new counters, never neither.
+void saveCounters() {
+  InternalFS.remove(COUNTERS_TMP_PATH); // FILE_O_WRITE appends to a leftover copy
+  File f(InternalFS);
+  if (!f.open(COUNTERS_TMP_PATH, FILE_O_WRITE))
+    return;
+  bool ok = f.write((const uint8_t *)&counters, sizeof(counters)) == sizeof(counters);
+  f.close();
+  if (ok)
+    InternalFS.rename(COUNTERS_TMP_PATH, COUNTERS_PATH);
+}
+
+// Records in a journal file of this pin map, or 0 when it is missing or foreign
+uint32_t countRecords(const char *path) {
+  File f(InternalFS);
+  if (!f.open(path, FILE_O_READ))
+    return 0;
+  FileHeader h;
+  uint32_t n = 0;
+  if (f.read(&h, sizeof(h)) == sizeof(h) && h.magic == JOURNAL_MAGIC && h.pinHash == pinHash_ &&
+      h.recordSize == sizeof(Record) && f.size() > sizeof(h))
+    n = (f.size() - sizeof(h)) / sizeof(Record);
+  f.close();
+  return n;
+}
+
+void writeHex(Print &out, const uint8_t *data, size_t len) {
+  static const char DIGITS[] = "0123456789ABCDEF";
+  for (size_t i = 0; i < len; i++) {
+    out.write(DIGITS[data[i] >> 4]);
+    out.write(DIGITS[data[i] & 0x0F]);
+  }
+}
+
+// Stream the records of one file as JREC lines
+void dumpFile(Print &out, const char *path, uint32_t records) {
+  if (records == 0)
+    return;
+  File f(InternalFS);
+  if (!f.open(path, FILE_O_READ))
+    return;
+  f.seek(sizeof(FileHeader));
+  Record line[RECORDS_PER_LINE];
+  int n;
+  while ((n = f.read(line, sizeof(line)) / (int)sizeof(Record)) > 0) {
+    out.print("Master: JREC ");
+    writeHex(out, (const uint8_t *)line, n * sizeof(Record));
+    out.println();
+  }
+  f.close();
+}
+
+void rotate() {
+  InternalFS.remove(OLD_PATH);
+  InternalFS.rename(JOURNAL_PATH, OLD_PATH);
+  oldRecords = fileRecords;
+  fileRecords = 0;
+}
+
+} // namespace
+
+bool begin(uint32_t pinHash, int numPins) {
+  pinHash_ = pinHash;
+  numPins_ = numPins < MAX_PINS ? numPins : MAX_PINS;
+  mounted = InternalFS.begin(); // formats an unformatted area
+  resetCounters();
+  if (!mounted)
+    return false;
+
+  File f(InternalFS);
+  Counters stored;
+  bool ok = false;
+  if (f.open(COUNTERS_PATH, FILE_O_READ)) {
+    ok = f.read(&stored, sizeof(stored)) == sizeof(stored) && stored.magic == COUNTERS_MAGIC &&
+         stored.pinHash == pinHash_;
+    f.close();
+  }
+  if (ok) {
+    counters = stored;
+    fileRecords = countRecords(JOURNAL_PATH);
+    oldRecords = countRecords(OLD_PATH);
+  } else if (InternalFS.exists(COUNTERS_PATH) || InternalFS.exists(JOURNAL_PATH)) {
+    clear(); // written for another pin map: its bitmaps would be misread
+  }
+  return true;
+}
+
+void add(Record rec) {
+  rec.run = ++counters.runs;
+  if (rec.flags & FLAG_PASS)
+    counters.passes++;
+  for (int i = 0; i < numPins_; i++) {
+    uint32_t bit = 1UL << i;
+    if ((rec.high & bit) && counters.high[i] < 0xFFFF)
+      counters.high[i]++;
+    if ((rec.low & bit) && counters.low[i] < 0xFFFF)
+      counters.low[i]++;
+    if ((rec.seq & bit) && counters.seq[i] < 0xFFFF)
+      counters.seq[i]++;
+  }
+  rec.crc = crc8((const uint8_t *)&rec, sizeof(rec) - 1);
+  if (pendingCount == 2 * BATCH)
+    flush(); // never idle long enough: write now rather than drop
+  pending[pendingCount++] = rec;
+  lastAddMs = millis();
+}
+
+void poll(unsigned long now, bool idle) {
+  if (!idle || pendingCount == 0)
+    return;
+  if (pendingCount >= BATCH || now - lastAddMs >= FLUSH_IDLE_MS)
+    flush();
+}
+
+void flush() {
+  if (!mounted || pendingCount == 0)
+    return;
+  if (fileRecords + pendingCount > MAX_RECORDS)
+    rotate();
+  File f(InternalFS);
+  if (!f.open(JOURNAL_PATH, FILE_O_WRITE))
+    return; // keep the batch in RAM and retry on the next poll
+  const uint32_t start = f.size();
+  bool ok = true;
+  if (start == 0) {
+    FileHeader h = {JOURNAL_MAGIC, pinHash_, (uint8_t)sizeof(Record), (uint8_t)numPins_, 0};
+    ok = f.write((const uint8_t *)&h, sizeof(h)) == sizeof(h);
+  }
+  if (ok) {
+    const size_t len = pendingCount * sizeof(Record);
+    f.seek(f.size());
+    ok = f.write((const uint8_t *)pending, len) == len;
+  }
+  if (!ok)
+    f.truncate(start); // drop the partial write; the batch stays in RAM for the next poll
+  f.close();
+  if (!ok)
+    return;
+  fileRecords += pendingCount;
+  pendingCount = 0;
+  saveCounters();
+}
+
+void dump(Print &out, const char *const *labels) {
+  uint32_t total = oldRecords + fileRecords + pendingCount;
+  out.print("Master: JOURNAL BEGIN records=");
+  out.print(total);
+  out.print(" recsize=");
+  out.print((int)sizeof(Record));
+  out.print(" pinhash=");
+  out.print(pinHash_, HEX);
+  out.print(" runs=");
+  out.print(counters.runs);
+  out.print(" passes=");
+  out.println(counters.passes);
+
+  if (mounted) {
+    dumpFile(out, OLD_PATH, oldRecords);
+    dumpFile(out, JOURNAL_PATH, fileRecords);
+  }
+  for (int i = 0; i < pendingCount; i += RECORDS_PER_LINE) {
+    int n = pendingCount - i < RECORDS_PER_LINE ? pendingCount - i : RECORDS_PER_LINE;
+    out.print("Master: JREC ");
+    writeHex(out, (const uint8_t *)&pending[i], n * sizeof(Record));
+    out.println();
+  }
+
+  for (int i = 0; i < numPins_; i++) {
+    out.print("Master: JPIN ");
+    out.print(labels[i]);
+    out.print(" high=");
+    out.print(counters.high[i]);
+    out.print(" low=");
+    out.print(counters.low[i]);
+    out.print(" seq=");
+    out.println(counters.seq[i]);
+  }
+  out.print("Master: JOURNAL END records=");
+  out.println(total);
+}
+
+void clear() {
+  pendingCount = 0;
+  fileRecords = oldRecords = 0;
+  resetCounters();
+  if (!mounted)
+    return;
+  InternalFS.remove(JOURNAL_PATH);
+  InternalFS.remove(OLD_PATH);
+  saveCounters();
+}
+
+} // namespace journal
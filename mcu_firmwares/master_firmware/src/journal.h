@@ -0,0 +1,77 @@
+/**
+ * On-flash result journal of the Master (InternalFS, LittleFS in the last
+ * 28 KB of the nRF52840 flash).
+ *
+ * Every finished run becomes one 24-byte Record. Records are buffered in RAM
+ * and appended in batches, so a batch of runs costs one rewrite of the last
+ * LittleFS block instead of one per run; LittleFS spreads the rewrites over
+ * its blocks. Per-pin defect counters are kept next to the journal and
+ * survive its rotation.
+ *
+ * Files:
+ *   /journal.bin   FileHeader + records, newest last
+ *   /journal.1     the previous journal.bin once it reached MAX_RECORDS
+ *   /counters.bin  Counters
+ *
+ * Not thread-safe: only the ui task calls these functions (setup() calls
+ * begin() before the tasks start). app/journal.py decodes the dump.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+namespace journal {
+
+// One run, little endian (app/journal.py RECORD)
+struct __attribute__((packed)) Record {
+  uint32_t run;        // run number since the last clear, set by add()
+  uint32_t high;       // ALL_HIGH defects (TestPins bitmap)
+  uint32_t low;        // ALL_LOW defects
+  uint32_t seq;        // SEQUENCE defects
+  uint32_t tested;     // pins the run checked (RETEST / pin mask), TestPins bitmap
+  uint16_t durationCs; // run duration, 10 ms units
+  uint8_t flags;       // FLAG_*
+  uint8_t crc;         // CRC-8 (poly 0x07) of the bytes above, set by add()
+};
+static_assert(sizeof(Record) == 24, "journal record layout");
+
+const uint8_t FLAG_PASS = 1 << 0;
+const uint8_t FLAG_FULL = 1 << 1;       // FULL mode (complete defect map)
+const uint8_t FLAG_STANDALONE = 1 << 2; // run without a host
+const uint8_t FLAG_RETEST = 1 << 3;     // RETEST mode (complete defect map of the tested pins)
+const uint8_t FLAG_XTALK_FAIL = 1 << 4; // crosstalk victims found
+const uint8_t FLAG_CLOCK_FAIL = 1 << 5; // HF or LF clock out of tolerance
+const uint8_t FLAG_VCC_FAIL = 1 << 6;   // VCC switch stage failed
+
+const int BATCH = 8;                     // records per flash write
+const unsigned long FLUSH_IDLE_MS = 30000; // write a partial batch after this idle time
+const uint32_t BLOCK_SIZE = 4096;        // LittleFS block of InternalFS
+const uint32_t HEADER_SIZE = 12;         // journal.cpp FileHeader
+const uint32_t MAX_RECORDS = (BLOCK_SIZE - HEADER_SIZE) / sizeof(Record); // per file (one block), then rotate
+static_assert(HEADER_SIZE + MAX_RECORDS * sizeof(Record) <= BLOCK_SIZE, "a full journal file fits one block");
+
+// Mount InternalFS and load the counters. A journal of another pin map
+// (other board profile) or record layout is cleared.
+bool begin(uint32_t pinHash, int numPins);
+
+// Count a finished run and queue its record for the next batch.
+void add(Record rec);
+
+// Write the pending batch when it is full or has waited FLUSH_IDLE_MS.
+// Flash erases stall the CPU, so pass idle = false while a run is sampling.
+void poll(unsigned long now, bool idle);
+
+// Write the pending records now.
+void flush();
+
+// Stream the whole journal and the counters in one transfer:
+//   "Master: JOURNAL BEGIN records=<n> recsize=24 pinhash=<hex> runs=<n> passes=<n>"
+//   "Master: JREC <hex>"   up to 6 records per line, oldest first
+//   "Master: JPIN <label> high=<n> low=<n> seq=<n>"   one line per test pin
+//   "Master: JOURNAL END records=<n>"
+void dump(Print &out, const char *const *labels);
+
+// Remove the journal files and zero the counters.
+void clear();
+
+} // namespace journal
@@ -1,30 +1,52 @@
 // Master firmware for NRF52840 nice!nano: ALL_HIGH -> ALL_LOW -> SEQUENCE
+//
+// FreeRTOS tasks (the Adafruit core already runs the scheduler):
+//   engine (TASK_PRIO_HIGH)   test state machine and pin sampling; blocks on
+//                             engineQueue and wakes only for events or its own
+//                             deadlines, so stage checks never wait behind I/O
+//   loop   (TASK_PRIO_NORMAL) USB I/O: parses commands, answers link/info
+//                             commands itself and is the only Serial writer
+//   ui     (TASK_PRIO_LOW)    button debounce, status LED, heartbeat lines,
+//                             result journal (flash writes happen here)
+// engine and ui print through LineWriter into their own tx queues.
+//
+// Without a USB host the Master runs standalone: it resets or detects the
+// Target, samples the Target's standalone script (include/standalone.h) and
+// shows the verdict on the LEDs. Every run is journaled on flash (journal.h).
+//
+// XTALK <i>|ALL measures crosstalk: while the Target toggles aggressor i (or
+// all lines), the GPIO SENSE/LATCH hardware catches coupled glitches on every
+// quiet line, however short, and the engine counts them per victim.
+// CLOCK HF|LF measures the Target's crystals against the Master's own HFXO
+// with hardware edge counting and timer capture (include/clock_test.h).
 #include <Adafruit_TinyUSB.h>
 #include <Arduino.h>
 #include <MiniShell.h>
+#include <malloc.h>
+
+#include "board_profile.h"
+#include "clock_test.h"
+#include "fast_gpio.h"
+#include "journal.h"
+#include "standalone.h"
+#include "vcc_test.h"
+
+using fastgpio::Pin;
 
 // --- Special pins ---
-#define LED_STATUS_PIN P0_15
-#define LED_PCB_PIN P0_13
-#define BUTTON_PIN P1_02
-#define RESET_SENDER_PIN P1_01
-
-// Master reads external Target power on P1_07; Target controls it via P0_13
-const int VCC_PIN = P1_07; // Target power monitor
-
-// Dynamic test pins (order is important and synchronized with Target)
-const int TEST_PINS[] = {VCC_PIN, // P1_07 (VCC) — externally controlled power,
-                                  // checked as a regular line
-                         P0_31, P0_29, P0_02, P1_15, P1_13, P1_11, P0_10, P0_09,
-                         P1_06, P1_04, P0_11, P1_00, P0_24, P0_22, P0_20, P0_17,
-                         P0_08, P0_06};
-const int NUM_TEST_PINS = sizeof(TEST_PINS) / sizeof(TEST_PINS[0]);
-
-// Labels for console printing (must match TEST_PINS order)
-const char *TEST_LABELS[] = {"P0_13(VCC)", "P0_31", "P0_29", "P0_02", "P1_15",
-                             "P1_13",      "P1_11", "P0_10", "P0_09", "P1_06",
-                             "P1_04",      "P0_11", "P1_00", "P0_24", "P0_22",
-                             "P0_20",      "P0_17", "P0_08", "P0_06"};
+using LedStatus = Pin<0, 15>;
+using LedPcb = Pin<0, 13>;
+using Button = Pin<1, 2>;
+using ResetSender = Pin<1, 1>;
+
+// Dynamic test pins from the board profile (order is synchronized with Target).
+// The first line senses the external Target power (P1_07 on the Master,
+// switched by the Target) and is checked as a regular line.
+using TestPins = board::Profile::MasterPins;
+const int NUM_TEST_PINS = board::NUM_TEST_PINS;
+
+// Labels for console printing (TestPins order)
+const char *const *TEST_LABELS = board::Profile::LABELS;
 
 // --- Test states ---
 enum TestState {
@@ -34,19 +56,51 @@ enum TestState {
   STATE_WAIT_ALL_LOW,
   STATE_SEQUENCE,
   STATE_SUCCESS,
-  STATE_FAIL
+  STATE_FAIL,
+  STATE_STANDALONE, // sampling the Target's standalone script
+  STATE_MONITOR     // streaming test-line changes (MONITOR ON)
 };
 
+// Test mode per run (START FAST|FULL|RETEST <mask>): FAST stops at the first
+// defect, FULL runs every stage and pin and reports the complete defect map.
+// RETEST runs like FULL on the pins of its mask only (rework verification).
+enum TestMode { MODE_FAST, MODE_FULL, MODE_RETEST };
+const char *MODE_NAMES[] = {"FAST", "FULL", "RETEST"};
+
 // --- Timing parameters ---
 const unsigned long DEBOUNCE_MS = 50;
+const unsigned long PIN_TIMEOUT_MS = 1000; // SEQUENCE: wait for the pin after NEXT_PIN
+const unsigned long AWAIT_PIN_MS = 500;    // SEQUENCE: AWAIT_PIN reprint period
+const unsigned long PIN_POLL_MS = 1;       // SEQUENCE: sampling period while a pin is awaited
+const unsigned long SEAT_POLL_MS = 5;      // seat detection sampling period
+const unsigned long UI_PERIOD_MS = 10;     // button/LED task period
+const unsigned long USB_POLL_MS = 1;       // USB RX poll period when no output is pending
+const unsigned long XTALK_WINDOW_US = 5000; // XTALK: glitch counting window per aggressor
+const unsigned long XTALK_SETTLE_US = 50;   // XTALK: pull-downs settle before counting
+const uint16_t XTALK_DEFECT_COUNT = 2;      // XTALK: glitch count that marks a victim defective
+const int32_t CLOCK_HF_LIMIT_PPM = 40;      // CLOCK: HFXO tolerance for the BLE radio
+const int32_t CLOCK_LF_LIMIT_PPM = 50;      // CLOCK: LFCLK tolerance (sleep clock accuracy)
+const unsigned long CLOCK_TIMEOUT_MS = 250; // CLOCK: no complete window: no signal
+const unsigned long VCC_START_TIMEOUT_MS = 1500; // VCC: ARMED -> host -> Target VCC CYCLE -> first ref edge
+const unsigned long VCC_TIMEOUT_MS = 250;   // VCC: longest wait for the next Target step
+const unsigned long MONITOR_POLL_MS = 1;      // MONITOR: sampling period (one RTOS tick)
+const unsigned long MONITOR_REFRESH_MS = 1000; // MONITOR: repeat the levels when nothing changes
+
+// --- Tasks ---
+const uint32_t ENGINE_STACK_WORDS = 768;
+const uint32_t UI_STACK_WORDS = 1024; // LittleFS calls
+const UBaseType_t ENGINE_QUEUE_LEN = 8;
+const UBaseType_t JOURNAL_QUEUE_LEN = 4;
+const UBaseType_t TX_QUEUE_LEN = 16;
+const size_t TX_CHUNK_LEN = 124;
 
 // --- State variables ---
-TestState state = STATE_HANDSHAKE;
+volatile TestState state = STATE_HANDSHAKE; // written by engine, read by ui
 unsigned long stateStartMs = 0;
-unsigned long lastBlinkMs = 0;
-unsigned long lastButtonEdgeMs = 0;
-bool lastButtonState = HIGH; // INPUT_PULLUP
+bool buttonPressed = false; // debounced press-and-release reported by ui
+unsigned long lastAwaitPrintMs = 0;
 int expectedIndex = 0;
+uint32_t activeMask = TestPins::all; // pins checked in this run (RETEST: its mask)
 bool pinWasHigh[NUM_TEST_PINS];
 bool precheckAllHighOk = false;
 bool precheckAllLowOk = false;
@@ -55,6 +109,22 @@ bool startAllHighRequested = false;
 bool startAllLowRequested = false;
 bool startSequenceRequested = false;
 bool nextPinRequested = false;
+unsigned long pinStartMs = 0; // NEXT_PIN arrival, for the per-pin timeout
+unsigned long pinStartUs = 0; // NEXT_PIN applied, for the reported settle time
+TestMode testMode = MODE_FULL;
+unsigned long runStartMs = 0;
+volatile bool lastRunPassed = false; // standalone idle shows it on the status LED
+
+// Defect map of the current run: one bit per TestPins index (PinGroup bitmap)
+uint32_t highDefects = 0; // read LOW in ALL_HIGH
+uint32_t lowDefects = 0;  // read HIGH in ALL_LOW
+uint32_t seqDefects = 0;  // missing, extra or out of order in SEQUENCE
+uint32_t xtalkDefects = 0; // victims with XTALK_DEFECT_COUNT coupled glitches
+bool xtalkRan = false;     // the host ran XTALK during this run (RESULT XTALK=)
+uint8_t clockFailures = 0; // CLOCK_HF / CLOCK_LF out of tolerance or silent
+bool clockRan = false;     // the host ran CLOCK during this run (RESULT CLOCK=)
+uint8_t vccFailures = 0;   // VCC_FAIL_* of the VCC switch stage
+bool vccRan = false;       // the host ran VCC during this run (RESULT VCC=)
 
 // One-time BEGIN log flags for stages
 bool beginAllHighPrinted = false;
@@ -62,7 +132,177 @@ bool beginAllLowPrinted = false;
 bool beginSequencePrinted = false;
 bool beginFailPrinted = false;
 
+// HELLO? descriptor: protocol version and feature bits (see app/descriptor.py)
+#ifndef FW_BUILD
+#define FW_BUILD 0 // set by platformio.ini (build time)
+#endif
+const int PROTO_VERSION = 2;
+const uint32_t FEAT_STAGES = 1UL << 0;     // ALL_HIGH / ALL_LOW / SEQUENCE
+const uint32_t FEAT_TRACE = 1UL << 1;      // TRACE ON/OFF, TIMESYNC
+const uint32_t FEAT_MEM = 1UL << 2;        // MEM
+const uint32_t FEAT_LINK_PROBE = 1UL << 3; // PING, BLAST
+const uint32_t FEAT_MODES = 1UL << 4;      // START FAST|FULL, RESULT line
+const uint32_t FEAT_AUTOSTART = 1UL << 5;  // AUTOSTART, TARGET_SEATED
+const uint32_t FEAT_PIN_ACK = 1UL << 6;    // PIN_UP once a SEQUENCE pin is raised
+const uint32_t FEAT_STANDALONE = 1UL << 7; // PC-less runs, JOURNAL? / JOURNAL CLEAR
+const uint32_t FEAT_XTALK = 1UL << 8;      // XTALK <i>|ALL glitch counts, RESULT XTALK=
+const uint32_t FEAT_CLOCK = 1UL << 9;      // CLOCK HF|LF ppm error, RESULT CLOCK=
+const uint32_t FEAT_PIN_MASK = 1UL << 11;  // START <mode> <mask>, stage <mask>, RESULT TESTED=
+const uint32_t FEAT_MONITOR = 1UL << 12;   // MONITOR ON|OFF streams test-line changes
+const uint32_t FEAT_VCC = 1UL << 13;       // VCC switch transition times and dropouts
+const uint32_t FEAT_RECOVERY = 1UL << 14;  // INIT aborts a host-paced run, RESET_TARGET
+
+// Timeline trace output (TRACE ON/OFF)
+volatile bool traceEnabled = false;
+
+// Auto start on target insertion (AUTOSTART <ms>, 0 = off)
+unsigned long seatStableMs = 0; // contacts must be stable this long
+bool seatPresent = false;       // last sampled presence
+bool seatArmed = true;          // re-armed once the fixture reads empty
+bool seatTrusted = true;        // the Target's beacon was seen since the last run
+unsigned long seatEdgeMs = 0;   // last presence change
+bool idlePullsOn = false;
+
+// Standalone runs (no USB host)
+volatile bool hostAttached = true; // a host has the port open (DTR), reported by the USB task
+bool saSynced = false;             // the Target's ALL_HIGH edge was seen
+unsigned long saSyncMs = 0;
+uint32_t saLastLevels = 0;
+int saStep = 0; // next sample: 0 ALL_HIGH, 1 ALL_LOW, 2 + i SEQUENCE pin i
+
+// Crosstalk measurement requested by the host (XTALK_ALL: all lines but VCC)
+const int XTALK_ALL = -1;
+bool xtalkRequested = false;
+int xtalkAggressor = 0;
+
+// Live contact monitor: last reported levels and when they were reported
+uint32_t monLevels = 0;
+unsigned long monStartUs = 0;
+unsigned long monReportMs = 0;
+
+// Clock measurement requested by the host; bits of clockFailures
+const uint8_t CLOCK_HF = 1 << 0;
+const uint8_t CLOCK_LF = 1 << 1;
+uint8_t clockRequested = 0;
+
+// Clock capture: TIMER3 timebase (16 MHz HFXO), TIMER4 edge counter.
+// PPI channels 0-2 and GPIOTE channel 0 are free: the SoftDevice stays off.
+const int CLOCK_GPIOTE_CH = 0;
+const int CLOCK_PPI_COUNT = 0; // edge -> TIMER4 COUNT
+const int CLOCK_PPI_FIRST = 1; // TIMER4 COMPARE[0] (edge 1) -> TIMER3 CAPTURE[0]
+const int CLOCK_PPI_LAST = 2;  // TIMER4 COMPARE[1] (edge 1 + cycles) -> TIMER3 CAPTURE[1]
+
+// VCC switch stage requested by the host; bits of vccFailures
+const uint8_t VCC_FAIL_OFF = 1 << 0;     // no or slow switch-off transition
+const uint8_t VCC_FAIL_ON = 1 << 1;      // no or slow switch-on transition
+const uint8_t VCC_FAIL_DROPOUT = 1 << 2; // the rail dipped while every line was HIGH
+bool vccRequested = false;
+
+// VCC capture: TIMER3 timebase, TIMER4 counts rail edges; both GPIOTE
+// channels sense either edge
+const int VCC_GPIOTE_REF = 1;
+const int VCC_GPIOTE_RAIL = 2;
+const int VCC_PPI_REF = 3;  // ref edge -> TIMER3 CAPTURE[0], fork TIMER4 CAPTURE[0]
+const int VCC_PPI_RAIL = 4; // rail edge -> TIMER3 CAPTURE[1], fork TIMER4 COUNT
+
+// Journal requests from the USB task, served by the ui task
+enum JournalRequest { JR_NONE, JR_DUMP, JR_CLEAR };
+volatile JournalRequest journalRequest = JR_NONE;
+
+// Serial command line buffer (static: no heap use in the command path)
+const size_t CMD_BUF_LEN = 128;
+char cmdBuf[CMD_BUF_LEN];
+size_t cmdLen = 0;
+bool cmdOverflow = false;
+
+// BLAST line filler (link throughput probe)
+const size_t BLAST_MAX_SIZE = 256;
+char blastFill[BLAST_MAX_SIZE];
+
+// Heap bounds from the nRF52 linker script
+extern "C" char __HeapBase, __HeapLimit;
+
+// Engine input: commands from the USB task and button presses from ui
+enum EngineEventType {
+  EV_INIT,
+  EV_START, // arg: TestMode, or -1 to keep the previous one
+  EV_MASK,  // arg: pin mask of the next START (sent just before it)
+  EV_START_ALL_HIGH, // stage events, arg: pin mask from this stage on, or 0 to keep it
+  EV_START_ALL_LOW,
+  EV_START_SEQUENCE,
+  EV_NEXT_PIN,
+  EV_AUTOSTART, // arg: seat stable ms
+  EV_BUTTON,
+  EV_HOST, // arg: 1 when a USB host opened the port, 0 when it left
+  EV_XTALK, // arg: aggressor index, or XTALK_ALL
+  EV_CLOCK, // arg: CLOCK_HF or CLOCK_LF
+  EV_MONITOR, // arg: 1 on, 0 off
+  EV_VCC
+};
+struct EngineEvent {
+  uint8_t type;
+  int32_t arg;
+  unsigned long ms; // millis() when the command was read
+};
+
+// Output chunk; a line longer than text[] is sent as several chunks with
+// more = true on all but the last, and the USB task keeps them together.
+struct TxChunk {
+  uint8_t len;
+  bool more;
+  char text[TX_CHUNK_LEN];
+};
+
+// Static task and queue storage: no heap, and visible in memreport
+StackType_t engineStack[ENGINE_STACK_WORDS];
+StackType_t uiStack[UI_STACK_WORDS];
+StaticTask_t engineTcb, uiTcb;
+uint8_t engineQueueBuf[ENGINE_QUEUE_LEN * sizeof(EngineEvent)];
+uint8_t engineTxBuf[TX_QUEUE_LEN * sizeof(TxChunk)];
+uint8_t uiTxBuf[TX_QUEUE_LEN * sizeof(TxChunk)];
+uint8_t journalQueueBuf[JOURNAL_QUEUE_LEN * sizeof(journal::Record)];
+StaticQueue_t engineQueueCb, engineTxCb, uiTxCb, journalQueueCb;
+QueueHandle_t engineQueue, engineTx, uiTx;
+QueueHandle_t journalQueue; // finished runs, engine -> ui
+TaskHandle_t usbTask;
+
+// Print sink that queues whole lines for the USB task
+class LineWriter : public Print {
+public:
+  explicit LineWriter(QueueHandle_t &queue) : queue_(queue) {}
+
+  size_t write(uint8_t c) override {
+    chunk_.text[chunk_.len++] = (char)c;
+    if (c == '\n')
+      send(false);
+    else if (chunk_.len == TX_CHUNK_LEN)
+      send(true);
+    return 1;
+  }
+  using Print::write;
+
+private:
+  void send(bool more) {
+    chunk_.more = more;
+    xQueueSend(queue_, &chunk_, portMAX_DELAY);
+    xTaskNotifyGive(usbTask);
+    chunk_.len = 0;
+  }
+
+  QueueHandle_t &queue_;
+  TxChunk chunk_ = {};
+};
+
+LineWriter engineOut(engineTx);
+LineWriter uiOut(uiTx);
+
+void setIdlePulls(bool on);
+void engineTask(void *);
+void uiTask(void *);
+
 void toState(TestState s) {
+  if (s == STATE_WAIT_ALL_HIGH)
+    setIdlePulls(false); // measure stages with plain inputs
   state = s;
   stateStartMs = millis();
 }
@@ -76,112 +316,991 @@ void setup() {
     delay(10);
   }
 #endif
-  pinMode(LED_STATUS_PIN, OUTPUT);
-  pinMode(LED_PCB_PIN, OUTPUT);
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
-  pinMode(RESET_SENDER_PIN, OUTPUT);
-  digitalWrite(RESET_SENDER_PIN, HIGH);
-  digitalWrite(LED_STATUS_PIN, LOW);
-  digitalWrite(LED_PCB_PIN, LOW);
+  LedStatus::mode(fastgpio::Output);
+  LedPcb::mode(fastgpio::Output);
+  Button::mode(fastgpio::InputPullup);
+  ResetSender::mode(fastgpio::Output);
+  ResetSender::high();
+  LedStatus::low();
+  LedPcb::low();
 
   // Test inputs
-  pinMode(VCC_PIN, INPUT);
-  for (int i = 0; i < NUM_TEST_PINS; i++) {
-    pinMode(TEST_PINS[i], INPUT);
+  TestPins::mode(fastgpio::Input);
+  for (int i = 0; i < NUM_TEST_PINS; i++)
     pinWasHigh[i] = false;
-  }
   toState(STATE_HANDSHAKE);
+  journal::begin(board::PIN_MAP_HASH, NUM_TEST_PINS);
+
+  // setup() runs in the loop task, which becomes the USB I/O task
+  usbTask = xTaskGetCurrentTaskHandle();
+  vTaskPrioritySet(nullptr, TASK_PRIO_NORMAL);
+  engineQueue = xQueueCreateStatic(ENGINE_QUEUE_LEN, sizeof(EngineEvent), engineQueueBuf,
+                                   &engineQueueCb);
+  engineTx = xQueueCreateStatic(TX_QUEUE_LEN, sizeof(TxChunk), engineTxBuf, &engineTxCb);
+  uiTx = xQueueCreateStatic(TX_QUEUE_LEN, sizeof(TxChunk), uiTxBuf, &uiTxCb);
+  journalQueue = xQueueCreateStatic(JOURNAL_QUEUE_LEN, sizeof(journal::Record), journalQueueBuf,
+                                    &journalQueueCb);
+  xTaskCreateStatic(engineTask, "engine", ENGINE_STACK_WORDS, nullptr, TASK_PRIO_HIGH,
+                    engineStack, &engineTcb);
+  xTaskCreateStatic(uiTask, "ui", UI_STACK_WORDS, nullptr, TASK_PRIO_LOW, uiStack, &uiTcb);
+}
+
+// Emit a timestamped trace event: "Master: TRACE <micros> <B|E|I> <name> [arg]".
+// B/E open and close a span, I marks an instant. No-op unless TRACE ON.
+void traceEvent(Print &out, char phase, const char *name, const char *arg = nullptr) {
+  if (!traceEnabled)
+    return;
+  out.print("Master: TRACE ");
+  out.print(micros());
+  out.print(' ');
+  out.print(phase);
+  out.print(' ');
+  out.print(name);
+  if (arg) {
+    out.print(' ');
+    out.print(arg);
+  }
+  out.println();
+}
+
+// Collect pending serial bytes without blocking. Returns the trimmed command
+// once a full line is buffered, nullptr otherwise. Over-long lines are dropped.
+const char *readCommand() {
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c != '\n') {
+      if (cmdLen < CMD_BUF_LEN - 1)
+        cmdBuf[cmdLen++] = c;
+      else
+        cmdOverflow = true;
+      continue;
+    }
+    cmdBuf[cmdLen] = '\0';
+    bool dropped = cmdOverflow;
+    cmdLen = 0;
+    cmdOverflow = false;
+    if (dropped)
+      continue;
+    char *s = cmdBuf;
+    while (isspace((unsigned char)*s))
+      s++;
+    char *e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1]))
+      *--e = '\0';
+    return s;
+  }
+  return nullptr;
+}
+
+// Report memory headroom:
+//   "Master: MEM HEAP used=<b> peak=<b> size=<b>"
+//   "Master: MEM STACK <task> free=<b>" for each FreeRTOS task
+//   "Master: MEM END"
+// peak is the heap arena newlib has claimed so far (its high-water mark);
+// free is the least stack a task has ever had left.
+void reportMemory() {
+  struct mallinfo mi = mallinfo();
+  Serial.print("Master: MEM HEAP used=");
+  Serial.print((unsigned long)mi.uordblks);
+  Serial.print(" peak=");
+  Serial.print((unsigned long)mi.arena);
+  Serial.print(" size=");
+  Serial.println((unsigned long)(&__HeapLimit - &__HeapBase));
+
+  UBaseType_t n = 0;
+#if configUSE_TRACE_FACILITY
+  static TaskStatus_t tasks[16];
+  n = uxTaskGetSystemState(tasks, sizeof(tasks) / sizeof(tasks[0]), nullptr);
+  for (UBaseType_t i = 0; i < n; i++) {
+    Serial.print("Master: MEM STACK ");
+    Serial.print(tasks[i].pcTaskName);
+    Serial.print(" free=");
+    Serial.println((unsigned long)(tasks[i].usStackHighWaterMark * sizeof(StackType_t)));
+  }
+#endif
+  if (n == 0) { // no task list available: report the loop task only
+    Serial.print("Master: MEM STACK ");
+    Serial.print(pcTaskGetName(nullptr));
+    Serial.print(" free=");
+    Serial.println((unsigned long)(uxTaskGetStackHighWaterMark(nullptr) * sizeof(StackType_t)));
+  }
+  Serial.println("Master: MEM END");
+}
+
+// PING <seq> [payload]: echo at once with the device clock for RTT/jitter:
+//   "Master: PONG <seq> <micros> [payload]"
+void handlePing(const char *args) {
+  unsigned long t = micros();
+  char *rest;
+  unsigned long seq = strtoul(args, &rest, 10);
+  while (*rest == ' ')
+    rest++;
+  Serial.print("Master: PONG ");
+  Serial.print(seq);
+  Serial.print(' ');
+  Serial.print(t);
+  if (*rest) {
+    Serial.print(' ');
+    Serial.print(rest);
+  }
+  Serial.println();
+}
+
+// BLAST <n> <size>: stream n lines of <size> filler bytes for throughput:
+//   "Master: BLAST <i> <micros> ....", then "Master: BLAST_END <n> <elapsed_us>"
+void handleBlast(const char *args) {
+  char *rest;
+  unsigned long n = strtoul(args, &rest, 10);
+  unsigned long size = strtoul(rest, nullptr, 10);
+  if (size > BLAST_MAX_SIZE)
+    size = BLAST_MAX_SIZE;
+  if (blastFill[0] != '.')
+    memset(blastFill, '.', sizeof(blastFill));
+  unsigned long t0 = micros();
+  for (unsigned long i = 0; i < n; i++) {
+    Serial.print("Master: BLAST ");
+    Serial.print(i);
+    Serial.print(' ');
+    Serial.print(micros());
+    Serial.print(' ');
+    Serial.write((const uint8_t *)blastFill, size);
+    Serial.println();
+  }
+  Serial.print("Master: BLAST_END ");
+  Serial.print(n);
+  Serial.print(' ');
+  Serial.println(micros() - t0);
+}
+
+// Weak pull-downs on the test lines while idle, so an empty fixture reads LOW.
+void setIdlePulls(bool on) {
+  if (on == idlePullsOn)
+    return;
+  TestPins::mode(on ? fastgpio::InputPulldown : fastgpio::Input);
+  idlePullsOn = on;
+}
+
+// A seated, powered Target drives the VCC line HIGH (its firmware raises VccCtrl
+// at boot); any other test line pulled HIGH also counts as contact.
+bool targetPresent() { return TestPins::anyHigh(); }
+
+// Debounced seat detection. Returns true once per insertion, when the
+// contacts have read present for seatStableMs; an equally stable empty
+// reading re-arms it. Seating wobble restarts the stability window.
+// A run leaves the Target's lines LOW, so a board that stays seated reads
+// empty: after a run, empty readings re-arm only once the beacon is back
+// (Target INIT or the end of its standalone script).
+bool pollTargetSeated(unsigned long now) {
+  if (seatStableMs == 0)
+    return false;
+  setIdlePulls(true);
+  bool present = targetPresent();
+  if (present != seatPresent) {
+    seatPresent = present;
+    seatEdgeMs = now;
+    return false;
+  }
+  if (now - seatEdgeMs < seatStableMs)
+    return false;
+  if (!present) {
+    seatArmed = seatArmed || seatTrusted;
+    return false;
+  }
+  seatTrusted = true;
+  if (!seatArmed)
+    return false;
+  seatArmed = false;
+  return true;
+}
+
+// A run started (command, button or seat): the board under test is taken, and
+// the lines it drives say nothing about contact until its beacon returns.
+void disarmSeat(unsigned long now) {
+  seatArmed = false;
+  seatTrusted = false;
+  seatEdgeMs = now;
+}
+
+// Print the labels of the pins in mask as "A,B,C", or "-" when empty.
+void printPinMask(uint32_t mask) {
+  if (!mask) {
+    engineOut.print('-');
+    return;
+  }
+  bool first = true;
+  for (int i = 0; i < NUM_TEST_PINS; i++) {
+    if (mask & (1UL << i)) {
+      if (!first)
+        engineOut.print(',');
+      engineOut.print(TEST_LABELS[i]);
+      first = false;
+    }
+  }
+}
+
+// End the run with its verdict and defect map:
+//   "Master: RESULT MODE=<FAST|FULL|RETEST> VERDICT=<PASS|FAIL> HIGH=.. LOW=.. SEQ=.. [XTALK=..]"
+// XTALK=, CLOCK= and VCC= only follow a run in which the host ran those stages;
+// TESTED= only a run limited to some pins.
+void finishRun() {
+  bool pass = (highDefects | lowDefects | seqDefects | xtalkDefects) == 0 && clockFailures == 0 &&
+              vccFailures == 0;
+  engineOut.print("Master: RESULT MODE=");
+  engineOut.print(MODE_NAMES[testMode]);
+  engineOut.print(pass ? " VERDICT=PASS HIGH=" : " VERDICT=FAIL HIGH=");
+  printPinMask(highDefects);
+  engineOut.print(" LOW=");
+  printPinMask(lowDefects);
+  engineOut.print(" SEQ=");
+  printPinMask(seqDefects);
+  if (xtalkRan) {
+    engineOut.print(" XTALK=");
+    printPinMask(xtalkDefects);
+  }
+  if (clockRan) {
+    engineOut.print(" CLOCK=");
+    engineOut.print(clockFailures == (CLOCK_HF | CLOCK_LF) ? "HF,LF"
+                    : clockFailures == CLOCK_HF          ? "HF"
+                    : clockFailures == CLOCK_LF          ? "LF"
+                                                         : "-");
+  }
+  if (vccRan) {
+    engineOut.print(" VCC=");
+    if (!vccFailures)
+      engineOut.print('-');
+    const char *sep = "";
+    if (vccFailures & VCC_FAIL_OFF) {
+      engineOut.print("OFF");
+      sep = ",";
+    }
+    if (vccFailures & VCC_FAIL_ON) {
+      engineOut.print(sep);
+      engineOut.print("ON");
+      sep = ",";
+    }
+    if (vccFailures & VCC_FAIL_DROPOUT) {
+      engineOut.print(sep);
+      engineOut.print("DROPOUT");
+    }
+  }
+  if (activeMask != TestPins::all) {
+    engineOut.print(" TESTED=");
+    printPinMask(activeMask);
+  }
+  engineOut.println();
+
+  // Journal the run; the ui task batches the flash writes
+  unsigned long cs = (millis() - runStartMs) / 10;
+  journal::Record rec = {};
+  rec.high = highDefects;
+  rec.low = lowDefects;
+  rec.seq = seqDefects;
+  rec.tested = activeMask;
+  rec.durationCs = cs > 0xFFFF ? 0xFFFF : (uint16_t)cs;
+  rec.flags = (pass ? journal::FLAG_PASS : 0) | (testMode == MODE_FULL ? journal::FLAG_FULL : 0) |
+              (testMode == MODE_RETEST ? journal::FLAG_RETEST : 0) |
+              (state == STATE_STANDALONE ? journal::FLAG_STANDALONE : 0) |
+              (xtalkDefects ? journal::FLAG_XTALK_FAIL : 0) | (clockFailures ? journal::FLAG_CLOCK_FAIL : 0) |
+              (vccFailures ? journal::FLAG_VCC_FAIL : 0);
+  xQueueSend(journalQueue, &rec, 0);
+
+  lastRunPassed = pass;
+  if (pass)
+    LedStatus::high();
+  LedPcb::low();
+  startSequenceRequested = false;
+  nextPinRequested = false;
+  toState(pass ? STATE_SUCCESS : STATE_FAIL);
+}
+
+// First pin of activeMask at or after index i; NUM_TEST_PINS when none is left.
+int nextActivePin(int i) {
+  while (i < NUM_TEST_PINS && !(activeMask & (1UL << i)))
+    i++;
+  return i;
+}
+
+// A SEQUENCE pin failed: FAST ends the run, FULL goes on with the next pin.
+void sequencePinFailed() {
+  nextPinRequested = false;
+  expectedIndex = nextActivePin(expectedIndex + 1);
+  if (testMode == MODE_FAST || expectedIndex >= NUM_TEST_PINS)
+    finishRun();
+}
+
+// Answer HELLO? with a one-line descriptor:
+//   "Master: DESC proto=<n> build=<id> profile=<name> pins=<n> pinhash=<hex> features=0x<hex> <timings>"
+void printDescriptor() {
+  Serial.print("Master: DESC proto=");
+  Serial.print(PROTO_VERSION);
+  Serial.print(" build=");
+  Serial.print((unsigned long)FW_BUILD);
+  Serial.print(" profile=");
+  Serial.print(board::Profile::NAME);
+  Serial.print(" pins=");
+  Serial.print(NUM_TEST_PINS);
+  Serial.print(" pinhash=");
+  Serial.print((unsigned long)board::PIN_MAP_HASH, HEX);
+  Serial.print(" features=0x");
+  Serial.print((unsigned long)(FEAT_STAGES | FEAT_TRACE | FEAT_MEM | FEAT_LINK_PROBE | FEAT_MODES |
+                               FEAT_AUTOSTART | FEAT_STANDALONE | FEAT_XTALK | FEAT_CLOCK |
+                               FEAT_PIN_MASK | FEAT_MONITOR | FEAT_VCC | FEAT_RECOVERY), HEX);
+  Serial.print(" pin_timeout_ms=");
+  Serial.print(PIN_TIMEOUT_MS);
+  Serial.print(" await_ms=");
+  Serial.print(AWAIT_PIN_MS);
+  Serial.print(" debounce_ms=");
+  Serial.print(DEBOUNCE_MS);
+  Serial.print(" autostart_ms=");
+  Serial.print(seatStableMs);
+  Serial.println();
 }
 
 // Pulse reset line low-high to reset Target (100 ms low)
-void pulseReset() {
-  Serial.println("Master: SENT RESET");
-  digitalWrite(RESET_SENDER_PIN, LOW); // drive LOW
-  delay(100);                          // pulse duration
-  digitalWrite(RESET_SENDER_PIN, HIGH);
+void pulseReset(Print &out) {
+  out.println("Master: SENT RESET");
+  ResetSender::low(); // drive LOW
+  delay(100);         // pulse duration
+  ResetSender::high();
 }
 
 // Enter DFU mode: double reset pulse. Used by FLASH/DFU command.
 void enterFlashMode() {
   Serial.println("Master: FLASH command received.");
-  pulseReset();
+  pulseReset(Serial);
   delay(500);
-  pulseReset();
+  pulseReset(Serial);
 }
 
-// Main state machine loop: handles serial commands, button, and test stages.
-void loop() {
-  unsigned long now = millis();
-
-  // Create a buffer for the current scan
-  int currentLevels[NUM_TEST_PINS];
-
-  // Serial commands
-  if (Serial.available()) {
-    String cmd = Serial.readStringUntil('\n');
-    cmd.trim();
-    if (cmd.equalsIgnoreCase("INIT")) {
-      if (state == STATE_HANDSHAKE || state == STATE_WAIT_BUTTON ||
-          state == STATE_FAIL || state == STATE_SUCCESS) {
-        // pulseReset();
-        Serial.println("Master: READY");
-        toState(STATE_WAIT_BUTTON);
-      }
-    } else if (cmd.equalsIgnoreCase("START")) {
-      startRequested = true;
-      Serial.println("Master: START command received.");
-    } else if (cmd.equalsIgnoreCase("START_ALL_HIGH")) {
+// Commands read by the USB task. Link and info commands are answered here;
+// test commands become engine events so the engine owns pins and state.
+void postEvent(EngineEventType type, int32_t arg = 0) {
+  EngineEvent ev = {(uint8_t)type, arg, millis()};
+  xQueueSend(engineQueue, &ev, portMAX_DELAY);
+}
+
+// Parse the "<hex mask>" argument of START and the stage commands. An empty
+// argument leaves mask at 0 (keep the current one); returns false when the
+// argument is malformed or selects no test pin.
+bool parseMaskArg(const char *arg, uint32_t &mask) {
+  mask = 0;
+  while (*arg == ' ')
+    arg++;
+  if (*arg == '\0')
+    return true;
+  char *end;
+  mask = strtoul(arg, &end, 16) & TestPins::all;
+  return end != arg && *end == '\0' && mask != 0;
+}
+
+void handleCommand(const char *cmd) {
+  if (strcasecmp(cmd, "TIMESYNC") != 0)
+    traceEvent(Serial, 'I', "cmd", cmd);
+  if (strcasecmp(cmd, "TIMESYNC") == 0) {
+    // Reply as fast as possible; the host pairs it with its own clock
+    Serial.print("Master: TIMESYNC ");
+    Serial.println(micros());
+  } else if (strcasecmp(cmd, "TRACE ON") == 0) {
+    traceEnabled = true;
+    Serial.println("Master: TRACE_ON");
+  } else if (strcasecmp(cmd, "TRACE OFF") == 0) {
+    traceEnabled = false;
+    Serial.println("Master: TRACE_OFF");
+  } else if (strcasecmp(cmd, "INIT") == 0) {
+    postEvent(EV_INIT);
+  } else if (strncasecmp(cmd, "START", 5) == 0 && (cmd[5] == ' ' || cmd[5] == '\0')) {
+    // START [FAST|FULL [<hex mask>]|RETEST <hex mask>]; without a mode the previous
+    // one is kept. The mask selects the pins the run tests (all by default, also
+    // for a bare START: a previous RETEST or masked run does not carry over).
+    const char *mode = cmd + 5;
+    while (*mode == ' ')
+      mode++;
+    int32_t runMode = -1;
+    uint32_t mask = 0;
+    bool ok = true;
+    if (strncasecmp(mode, "FAST", 4) == 0 && (mode[4] == ' ' || mode[4] == '\0')) {
+      runMode = MODE_FAST;
+      ok = parseMaskArg(mode + 4, mask);
+    } else if (strncasecmp(mode, "FULL", 4) == 0 && (mode[4] == ' ' || mode[4] == '\0')) {
+      runMode = MODE_FULL;
+      ok = parseMaskArg(mode + 4, mask);
+    } else if (strncasecmp(mode, "RETEST ", 7) == 0) {
+      runMode = MODE_RETEST;
+      ok = parseMaskArg(mode + 7, mask) && mask != 0;
+    }
+    if (!ok) {
+      Serial.println("Master: START REJECTED");
+      return;
+    }
+    postEvent(EV_MASK, (int32_t)(mask ? mask : TestPins::all));
+    postEvent(EV_START, runMode);
+  } else if (strncasecmp(cmd, "START_", 6) == 0) {
+    // START_ALL_HIGH|START_ALL_LOW|START_SEQUENCE [<hex mask>]
+    const char *arg = strchr(cmd, ' ');
+    size_t len = arg ? (size_t)(arg - cmd) : strlen(cmd);
+    EngineEventType type;
+    if (len == 14 && strncasecmp(cmd, "START_ALL_HIGH", len) == 0)
+      type = EV_START_ALL_HIGH;
+    else if (len == 13 && strncasecmp(cmd, "START_ALL_LOW", len) == 0)
+      type = EV_START_ALL_LOW;
+    else if (len == 14 && strncasecmp(cmd, "START_SEQUENCE", len) == 0)
+      type = EV_START_SEQUENCE;
+    else
+      return;
+    uint32_t mask;
+    if (!parseMaskArg(arg ? arg : "", mask)) {
+      Serial.println("Master: STAGE REJECTED");
+      return;
+    }
+    postEvent(type, (int32_t)mask);
+  } else if (strcasecmp(cmd, "NEXT_PIN") == 0) {
+    postEvent(EV_NEXT_PIN);
+  } else if (strcasecmp(cmd, "FLASH") == 0 || strcasecmp(cmd, "DFU") == 0) {
+    enterFlashMode(); // its delay()s block this task only
+  } else if (strcasecmp(cmd, "RESET_TARGET") == 0) {
+    pulseReset(Serial); // host recovery: the Target reboots and says hello again
+  } else if (strcasecmp(cmd, "HELLO?") == 0) {
+    printDescriptor();
+  } else if (strcasecmp(cmd, "MEM") == 0) {
+    reportMemory();
+  } else if (strncasecmp(cmd, "PING", 4) == 0 && (cmd[4] == ' ' || cmd[4] == '\0')) {
+    handlePing(cmd + 4);
+  } else if (strncasecmp(cmd, "BLAST ", 6) == 0) {
+    handleBlast(cmd + 6);
+  } else if (strncasecmp(cmd, "AUTOSTART", 9) == 0 && (cmd[9] == ' ' || cmd[9] == '\0')) {
+    postEvent(EV_AUTOSTART, (int32_t)strtoul(cmd + 9, nullptr, 10));
+  } else if (strcasecmp(cmd, "JOURNAL?") == 0) {
+    journalRequest = JR_DUMP;
+  } else if (strcasecmp(cmd, "JOURNAL CLEAR") == 0) {
+    journalRequest = JR_CLEAR;
+  } else if (strncasecmp(cmd, "XTALK ", 6) == 0) {
+    const char *arg = cmd + 6;
+    char *end;
+    long i = strtol(arg, &end, 10);
+    if (strcasecmp(arg, "ALL") == 0)
+      postEvent(EV_XTALK, XTALK_ALL);
+    else if (end != arg && *end == '\0' && i >= 1 && i < NUM_TEST_PINS)
+      postEvent(EV_XTALK, (int32_t)i);
+    else
+      Serial.println("Master: XTALK REJECTED");
+  } else if (strcasecmp(cmd, "CLOCK HF") == 0) {
+    postEvent(EV_CLOCK, CLOCK_HF);
+  } else if (strcasecmp(cmd, "CLOCK LF") == 0) {
+    postEvent(EV_CLOCK, CLOCK_LF);
+  } else if (strcasecmp(cmd, "VCC") == 0) {
+    postEvent(EV_VCC, 0);
+  } else if (strcasecmp(cmd, "MONITOR ON") == 0) {
+    postEvent(EV_MONITOR, 1);
+  } else if (strcasecmp(cmd, "MONITOR OFF") == 0) {
+    postEvent(EV_MONITOR, 0);
+  }
+}
+
+// Apply one event to the engine state; the next engineStep() acts on it.
+void applyEvent(const EngineEvent &ev) {
+  switch (ev.type) {
+  case EV_INIT: {
+    // INIT during a host-paced run: the host lost it (a line or a port dropped)
+    // and starts over; the abandoned run is neither reported nor journaled
+    const bool abandon = state == STATE_WAIT_ALL_HIGH || state == STATE_WAIT_ALL_LOW ||
+                         state == STATE_SEQUENCE;
+    if (abandon) {
+      engineOut.println("Master: RUN ABORTED");
+      startSequenceRequested = false;
+      nextPinRequested = false;
+      LedPcb::low();
+    }
+    if (abandon || state == STATE_HANDSHAKE || state == STATE_WAIT_BUTTON || state == STATE_FAIL ||
+        state == STATE_SUCCESS || state == STATE_MONITOR) {
+      // pulseReset();
+      engineOut.println("Master: READY");
+      toState(STATE_WAIT_BUTTON);
+    }
+  } break;
+  case EV_MASK:
+    // Only between runs: a START that arrives mid-run must not narrow the running one
+    if (state == STATE_HANDSHAKE || state == STATE_WAIT_BUTTON || state == STATE_FAIL ||
+        state == STATE_SUCCESS || state == STATE_MONITOR)
+      activeMask = (uint32_t)ev.arg;
+    break;
+  case EV_START:
+    if (ev.arg >= 0)
+      testMode = (TestMode)ev.arg;
+    startRequested = true;
+    disarmSeat(ev.ms); // TARGET_SEATED must not follow for the board this run takes
+    engineOut.print("Master: START command received. MODE=");
+    engineOut.println(MODE_NAMES[testMode]);
+    break;
+  case EV_START_ALL_HIGH:
+  case EV_START_ALL_LOW:
+  case EV_START_SEQUENCE:
+    // A stage mask narrows the run before its sequence starts (never mid-sequence)
+    if (ev.arg && !startSequenceRequested) {
+      activeMask = (uint32_t)ev.arg;
+      expectedIndex = nextActivePin(0);
+    }
+    if (ev.type == EV_START_ALL_HIGH)
       startAllHighRequested = true;
-    } else if (cmd.equalsIgnoreCase("START_ALL_LOW")) {
+    else if (ev.type == EV_START_ALL_LOW)
       startAllLowRequested = true;
-    } else if (cmd.equalsIgnoreCase("START_SEQUENCE")) {
+    else
       startSequenceRequested = true;
-    } else if (cmd.equalsIgnoreCase("NEXT_PIN")) {
-      nextPinRequested = true;
-    } else if (cmd.equalsIgnoreCase("FLASH") || cmd.equalsIgnoreCase("DFU")) {
-      enterFlashMode();
+    break;
+  case EV_NEXT_PIN:
+    nextPinRequested = true;
+    pinStartMs = ev.ms;
+    pinStartUs = micros();
+    break;
+  case EV_AUTOSTART:
+    seatStableMs = (unsigned long)ev.arg;
+    if (seatStableMs == 0)
+      setIdlePulls(false);
+    engineOut.print("Master: AUTOSTART ");
+    engineOut.println(seatStableMs);
+    break;
+  case EV_BUTTON:
+    // Only idle and failed runs react to the button; it also ends the monitor
+    buttonPressed = (state == STATE_WAIT_BUTTON || state == STATE_FAIL || state == STATE_MONITOR);
+    break;
+  case EV_HOST:
+    hostAttached = ev.arg != 0;
+    if (hostAttached) {
+      // Back to the hello beacon so the app can INIT; a standalone run is dropped
+      if (state == STATE_STANDALONE)
+        LedPcb::low();
+      if (state == STATE_WAIT_BUTTON || state == STATE_FAIL || state == STATE_STANDALONE ||
+          state == STATE_MONITOR)
+        toState(STATE_HANDSHAKE);
+    } else {
+      // Seat detection starts standalone runs; a host-paced run cannot finish
+      seatStableMs = standalone::SEAT_MS;
+      if (state == STATE_HANDSHAKE || state == STATE_WAIT_ALL_HIGH || state == STATE_WAIT_ALL_LOW ||
+          state == STATE_SEQUENCE || state == STATE_MONITOR)
+        toState(STATE_WAIT_BUTTON);
     }
+    break;
+  case EV_XTALK:
+    xtalkAggressor = ev.arg;
+    xtalkRequested = true;
+    break;
+  case EV_CLOCK:
+    clockRequested = (uint8_t)ev.arg;
+    break;
+  case EV_VCC:
+    vccRequested = true;
+    break;
+  case EV_MONITOR:
+    if (ev.arg && (state == STATE_WAIT_BUTTON || state == STATE_FAIL || state == STATE_SUCCESS)) {
+      engineOut.println("Master: MONITOR ON");
+      setIdlePulls(true); // a pin without contact reads LOW, not floating
+      monStartUs = micros();
+      monLevels = ~TestPins::all; // forces the first report
+      toState(STATE_MONITOR);
+    } else if (ev.arg && state != STATE_MONITOR) {
+      engineOut.println("Master: MONITOR BUSY");
+    } else if (!ev.arg && state == STATE_MONITOR) {
+      engineOut.println("Master: MONITOR OFF");
+      toState(STATE_WAIT_BUTTON);
+    }
+    break;
   }
+}
 
-  // Button handling with debouncing
-  bool btn = digitalRead(BUTTON_PIN);
-  if (btn != lastButtonState) {
-    lastButtonEdgeMs = now;
-    lastButtonState = btn;
+// Start a run without a host. After a button press the Target is reset so it
+// plays its script again; a freshly seated Target has just booted and plays it.
+void startStandaloneRun(bool resetTarget) {
+  engineOut.println("Master: START STANDALONE");
+  runStartMs = millis();
+  disarmSeat(runStartMs);
+  testMode = MODE_FULL; // the journal keeps complete defect maps
+  activeMask = TestPins::all;
+  highDefects = lowDefects = seqDefects = xtalkDefects = 0;
+  xtalkRan = false;
+  clockFailures = 0;
+  clockRan = false;
+  vccFailures = 0;
+  vccRan = false;
+  lastRunPassed = false;
+  beginFailPrinted = false;
+  LedStatus::low();
+  LedPcb::high();
+  if (resetTarget)
+    pulseReset(engineOut);
+  setIdlePulls(true); // lines of a rebooting Target read LOW, not floating
+  saSynced = false;
+  saStep = 0;
+  saLastLevels = TestPins::read();
+  toState(STATE_STANDALONE);
+}
+
+// Offset of the next standalone sample from the sync edge
+unsigned long standaloneSampleMs() {
+  if (saStep == 0)
+    return standalone::allHighSampleMs();
+  if (saStep == 1)
+    return standalone::allLowSampleMs();
+  return standalone::pinSampleMs(saStep - 2);
+}
+
+// Count coupled glitches on the quiet lines while the Target toggles the
+// aggressor (XTALK_UP acked). Every quiet line senses its disturbed level:
+// signal lines idle LOW on the pull-downs and latch HIGH, the VCC line idles
+// HIGH and latches a dip. A count is one poll that found the LATCH bit set,
+// so a short to the aggressor counts on every poll. Reports
+//   "Master: XTALK <aggressor|ALL> polls=<n> <victim>=<count>,..." ("-": none)
+// and marks victims with XTALK_DEFECT_COUNT glitches in the run's defect map.
+void measureXtalk(int aggressor) {
+  const uint32_t quiet = (aggressor == XTALK_ALL ? 1UL : TestPins::all & ~(1UL << aggressor)) & activeMask;
+  for (int i = 0; i < NUM_TEST_PINS; i++) {
+    if (!(quiet & (1UL << i)))
+      TestPins::modeAt(i, fastgpio::Input);
+    else if (i == 0)
+      TestPins::modeAt(i, fastgpio::Input, fastgpio::SenseLow);
+    else
+      TestPins::modeAt(i, fastgpio::InputPulldown, fastgpio::SenseHigh);
   }
-  bool pressed = (btn == LOW) && (now - lastButtonEdgeMs > DEBOUNCE_MS);
+  delayMicroseconds(XTALK_SETTLE_US);
 
-  switch (state) {
-  case STATE_HANDSHAKE: {
-    if (now - lastBlinkMs >= 200) {
-      Serial.println("Hello! I am Master!");
-      lastBlinkMs = now;
-      digitalWrite(LED_STATUS_PIN, !digitalRead(LED_STATUS_PIN));
+  traceEvent(engineOut, 'B', "xtalk");
+  uint16_t counts[NUM_TEST_PINS] = {};
+  unsigned long polls = 0;
+  TestPins::clearLatch();
+  const unsigned long t0 = micros();
+  while (micros() - t0 < XTALK_WINDOW_US) {
+    uint32_t hit = TestPins::latched() & quiet;
+    polls++;
+    if (!hit)
+      continue;
+    TestPins::clearLatch();
+    for (; hit; hit &= hit - 1) {
+      int v = __builtin_ctz(hit);
+      if (counts[v] < 0xFFFF)
+        counts[v]++;
     }
-  } break;
+  }
+  traceEvent(engineOut, 'E', "xtalk");
+  TestPins::mode(idlePullsOn ? fastgpio::InputPulldown : fastgpio::Input); // SENSE off
+
+  engineOut.print("Master: XTALK ");
+  engineOut.print(aggressor == XTALK_ALL ? "ALL" : TEST_LABELS[aggressor]);
+  engineOut.print(" polls=");
+  engineOut.print(polls);
+  engineOut.print(' ');
+  bool first = true;
+  for (int i = 0; i < NUM_TEST_PINS; i++) {
+    if (!counts[i])
+      continue;
+    if (!first)
+      engineOut.print(',');
+    engineOut.print(TEST_LABELS[i]);
+    engineOut.print('=');
+    engineOut.print(counts[i]);
+    first = false;
+    if (counts[i] >= XTALK_DEFECT_COUNT)
+      xtalkDefects |= 1UL << i;
+  }
+  if (first)
+    engineOut.print('-');
+  engineOut.println();
+  xtalkRan = true;
+}
+
+// Time `cycles` periods of the Target's clock output: its rising edges count
+// in TIMER4, which captures the free-running TIMER3 at edge 1 and edge
+// 1 + cycles. The engine sleeps meanwhile; returns false when the window
+// does not complete within CLOCK_TIMEOUT_MS.
+bool captureClock(uint32_t cycles, uint32_t &ticks) {
+  const int pin = clocktest::PIN_INDEX;
+  clocktest::startHfxo(); // the reference: TIMER3 would run on HFINT otherwise
+  TestPins::modeAt(pin, fastgpio::Input);
+
+  NRF_TIMER3->TASKS_STOP = 1;
+  NRF_TIMER3->TASKS_CLEAR = 1;
+  NRF_TIMER3->MODE = TIMER_MODE_MODE_Timer;
+  NRF_TIMER3->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+  NRF_TIMER3->PRESCALER = 0;
+  NRF_TIMER4->TASKS_STOP = 1;
+  NRF_TIMER4->TASKS_CLEAR = 1;
+  NRF_TIMER4->MODE = TIMER_MODE_MODE_Counter;
+  NRF_TIMER4->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+  NRF_TIMER4->CC[0] = 1;
+  NRF_TIMER4->CC[1] = 1 + cycles;
+  NRF_TIMER4->EVENTS_COMPARE[1] = 0;
+
+  NRF_GPIOTE->CONFIG[CLOCK_GPIOTE_CH] =
+      (GPIOTE_CONFIG_MODE_Event << GPIOTE_CONFIG_MODE_Pos) |
+      ((uint32_t)(TestPins::numbers[pin] & 31) << GPIOTE_CONFIG_PSEL_Pos) |
+      ((uint32_t)TestPins::ports[pin] << GPIOTE_CONFIG_PORT_Pos) |
+      (GPIOTE_CONFIG_POLARITY_LoToHi << GPIOTE_CONFIG_POLARITY_Pos);
+  NRF_GPIOTE->EVENTS_IN[CLOCK_GPIOTE_CH] = 0;
+  NRF_PPI->CH[CLOCK_PPI_COUNT].EEP = (uint32_t)&NRF_GPIOTE->EVENTS_IN[CLOCK_GPIOTE_CH];
+  NRF_PPI->CH[CLOCK_PPI_COUNT].TEP = (uint32_t)&NRF_TIMER4->TASKS_COUNT;
+  NRF_PPI->CH[CLOCK_PPI_FIRST].EEP = (uint32_t)&NRF_TIMER4->EVENTS_COMPARE[0];
+  NRF_PPI->CH[CLOCK_PPI_FIRST].TEP = (uint32_t)&NRF_TIMER3->TASKS_CAPTURE[0];
+  NRF_PPI->CH[CLOCK_PPI_LAST].EEP = (uint32_t)&NRF_TIMER4->EVENTS_COMPARE[1];
+  NRF_PPI->CH[CLOCK_PPI_LAST].TEP = (uint32_t)&NRF_TIMER3->TASKS_CAPTURE[1];
+  const uint32_t channels = (1UL << CLOCK_PPI_COUNT) | (1UL << CLOCK_PPI_FIRST) | (1UL << CLOCK_PPI_LAST);
+  NRF_TIMER3->TASKS_START = 1;
+  NRF_TIMER4->TASKS_START = 1;
+  NRF_PPI->CHENSET = channels;
+
+  const unsigned long t0 = millis();
+  while (!NRF_TIMER4->EVENTS_COMPARE[1] && millis() - t0 < CLOCK_TIMEOUT_MS)
+    vTaskDelay(pdMS_TO_TICKS(5));
+  const bool done = NRF_TIMER4->EVENTS_COMPARE[1];
+
+  NRF_PPI->CHENCLR = channels;
+  NRF_GPIOTE->CONFIG[CLOCK_GPIOTE_CH] = 0;
+  NRF_TIMER3->TASKS_STOP = 1;
+  NRF_TIMER4->TASKS_STOP = 1;
+  TestPins::modeAt(pin, idlePullsOn ? fastgpio::InputPulldown : fastgpio::Input);
+  ticks = NRF_TIMER3->CC[1] - NRF_TIMER3->CC[0];
+  return done;
+}
+
+// CLOCK HF|LF, Target output acked (CLOCK_UP). Reports
+//   "Master: CLOCK <HF|LF> ppm=<+x.x> cycles=<n> ticks=<n> limit=<ppm>"
+// or "Master: CLOCK <HF|LF> NO SIGNAL"; out-of-tolerance clocks fail the run.
+void measureClock(uint8_t which) {
+  const bool hf = which == CLOCK_HF;
+  const uint32_t hz = hf ? clocktest::HF_HZ : clocktest::LF_HZ;
+  const uint32_t cycles = hf ? clocktest::HF_CYCLES : clocktest::LF_CYCLES;
+  const int32_t limit = hf ? CLOCK_HF_LIMIT_PPM : CLOCK_LF_LIMIT_PPM;
+
+  traceEvent(engineOut, 'B', "clock", hf ? "HF" : "LF");
+  uint32_t ticks = 0;
+  const bool ok = captureClock(cycles, ticks) && ticks > 0;
+  traceEvent(engineOut, 'E', "clock", hf ? "HF" : "LF");
+  clockRan = true;
+
+  engineOut.print("Master: CLOCK ");
+  engineOut.print(hf ? "HF" : "LF");
+  if (!ok) {
+    engineOut.println(" NO SIGNAL");
+    clockFailures |= which;
+    return;
+  }
+  // A fast Target clock packs the cycles into fewer Master ticks
+  const uint32_t expected = clocktest::expectedTicks(hz, cycles);
+  const float ppm = ((float)expected - (float)ticks) * 1e6f / (float)ticks;
+  engineOut.print(" ppm=");
+  if (ppm >= 0)
+    engineOut.print('+');
+  engineOut.print(ppm, 1);
+  engineOut.print(" cycles=");
+  engineOut.print(cycles);
+  engineOut.print(" ticks=");
+  engineOut.print(ticks);
+  engineOut.print(" limit=");
+  engineOut.println(limit);
+  if (ppm > limit || ppm < -limit)
+    clockFailures |= which;
+}
+
+// Wait for the next edge of the Target's ref line; returns its TIMER3 time
+// and the rail edge count at that instant, or false after timeoutMs.
+bool waitVccStep(uint32_t &ticks, uint32_t &railEdges, unsigned long timeoutMs) {
+  const unsigned long t0 = millis();
+  while (!NRF_GPIOTE->EVENTS_IN[VCC_GPIOTE_REF]) {
+    if (millis() - t0 >= timeoutMs)
+      return false;
+    vTaskDelay(1);
+  }
+  NRF_GPIOTE->EVENTS_IN[VCC_GPIOTE_REF] = 0;
+  ticks = NRF_TIMER3->CC[0];
+  railEdges = NRF_TIMER4->CC[0];
+  return true;
+}
+
+// The rail transition that followed a ref edge: sleeps until `limitUs` after
+// it, then returns the time of the rail's last edge (ringing included) when
+// the rail crossed to `level`; UINT32_MAX when it did not.
+uint32_t vccTransitionTicks(uint32_t refTicks, uint32_t refEdges, uint32_t limitUs, bool level) {
+  vTaskDelay(pdMS_TO_TICKS(limitUs / 1000 + 1));
+  NRF_TIMER4->TASKS_CAPTURE[1] = 1;
+  const uint32_t edges = NRF_TIMER4->CC[1];
+  const uint32_t railTicks = NRF_TIMER3->CC[1];
+  if (edges == refEdges || TestPins::readAt(vcctest::VCC_INDEX) != level)
+    return UINT32_MAX;
+  return railTicks - refTicks;
+}
+
+// Print " <name>=<us>" with 1/16 us resolution, or "=-" when there was no transition
+void printVccTime(const char *name, uint32_t ticks) {
+  engineOut.print(' ');
+  engineOut.print(name);
+  engineOut.print('=');
+  if (ticks == UINT32_MAX)
+    engineOut.print('-');
+  else
+    engineOut.print(ticks / (clocktest::TIMER_HZ / 1000000.0f), 1);
+}
+
+// VCC switch stage (see vcc_test.h): arm the captures, ack "Master: VCC ARMED"
+// so the host starts the Target's VCC CYCLE, then follow its three ref edges.
+// Reports
+//   "Master: VCC off_us=<x|-> on_us=<x|-> dropouts=<n> limit_off_us=<n> limit_on_us=<n>"
+// or "Master: VCC NO SIGNAL"; a missing or slow transition or any dropout fails the run.
+void measureVcc() {
+  const int ref = vcctest::REF_INDEX;
+  const int rail = vcctest::VCC_INDEX;
+  clocktest::startHfxo();
+  TestPins::modeAt(ref, fastgpio::Input);
+  TestPins::modeAt(rail, fastgpio::InputPulldown); // the switched-off rail discharges into it
+
+  NRF_TIMER3->TASKS_STOP = 1;
+  NRF_TIMER3->TASKS_CLEAR = 1;
+  NRF_TIMER3->MODE = TIMER_MODE_MODE_Timer;
+  NRF_TIMER3->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+  NRF_TIMER3->PRESCALER = 0;
+  NRF_TIMER4->TASKS_STOP = 1;
+  NRF_TIMER4->TASKS_CLEAR = 1;
+  NRF_TIMER4->MODE = TIMER_MODE_MODE_Counter;
+  NRF_TIMER4->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+
+  const int channels[] = {VCC_GPIOTE_REF, VCC_GPIOTE_RAIL};
+  const int lines[] = {ref, rail};
+  for (int c = 0; c < 2; c++) {
+    NRF_GPIOTE->CONFIG[channels[c]] =
+        (GPIOTE_CONFIG_MODE_Event << GPIOTE_CONFIG_MODE_Pos) |
+        ((uint32_t)(TestPins::numbers[lines[c]] & 31) << GPIOTE_CONFIG_PSEL_Pos) |
+        ((uint32_t)TestPins::ports[lines[c]] << GPIOTE_CONFIG_PORT_Pos) |
+        (GPIOTE_CONFIG_POLARITY_Toggle << GPIOTE_CONFIG_POLARITY_Pos);
+    NRF_GPIOTE->EVENTS_IN[channels[c]] = 0;
+  }
+  NRF_PPI->CH[VCC_PPI_REF].EEP = (uint32_t)&NRF_GPIOTE->EVENTS_IN[VCC_GPIOTE_REF];
+  NRF_PPI->CH[VCC_PPI_REF].TEP = (uint32_t)&NRF_TIMER3->TASKS_CAPTURE[0];
+  NRF_PPI->FORK[VCC_PPI_REF].TEP = (uint32_t)&NRF_TIMER4->TASKS_CAPTURE[0];
+  NRF_PPI->CH[VCC_PPI_RAIL].EEP = (uint32_t)&NRF_GPIOTE->EVENTS_IN[VCC_GPIOTE_RAIL];
+  NRF_PPI->CH[VCC_PPI_RAIL].TEP = (uint32_t)&NRF_TIMER3->TASKS_CAPTURE[1];
+  NRF_PPI->FORK[VCC_PPI_RAIL].TEP = (uint32_t)&NRF_TIMER4->TASKS_COUNT;
+  const uint32_t ppi = (1UL << VCC_PPI_REF) | (1UL << VCC_PPI_RAIL);
+  NRF_TIMER3->TASKS_START = 1;
+  NRF_TIMER4->TASKS_START = 1;
+  NRF_PPI->CHENSET = ppi;
+  engineOut.println("Master: VCC ARMED");
+
+  traceEvent(engineOut, 'B', "vcc");
+  // Ref edges: watch start, switch off, switch on. The first one waits for the
+  // host round trip to the Target's VCC CYCLE, the others only for its script.
+  uint32_t refTicks[3], refEdges[3];
+  uint32_t offTicks = UINT32_MAX, onTicks = UINT32_MAX;
+  bool ok = waitVccStep(refTicks[0], refEdges[0], VCC_START_TIMEOUT_MS) &&
+            waitVccStep(refTicks[1], refEdges[1], VCC_TIMEOUT_MS);
+  if (ok) {
+    offTicks = vccTransitionTicks(refTicks[1], refEdges[1], vcctest::OFF_LIMIT_US, false);
+    ok = waitVccStep(refTicks[2], refEdges[2], VCC_TIMEOUT_MS);
+  }
+  if (ok)
+    onTicks = vccTransitionTicks(refTicks[2], refEdges[2], vcctest::ON_LIMIT_US, true);
+  traceEvent(engineOut, 'E', "vcc");
+
+  NRF_PPI->CHENCLR = ppi;
+  NRF_PPI->FORK[VCC_PPI_REF].TEP = 0;
+  NRF_PPI->FORK[VCC_PPI_RAIL].TEP = 0;
+  NRF_GPIOTE->CONFIG[VCC_GPIOTE_REF] = 0;
+  NRF_GPIOTE->CONFIG[VCC_GPIOTE_RAIL] = 0;
+  NRF_TIMER3->TASKS_STOP = 1;
+  NRF_TIMER4->TASKS_STOP = 1;
+  TestPins::modeAt(ref, idlePullsOn ? fastgpio::InputPulldown : fastgpio::Input);
+  TestPins::modeAt(rail, idlePullsOn ? fastgpio::InputPulldown : fastgpio::Input);
+  vccRan = true;
+
+  if (!ok) {
+    engineOut.println("Master: VCC NO SIGNAL");
+    vccFailures |= VCC_FAIL_OFF | VCC_FAIL_ON;
+    return;
+  }
+  const uint32_t ticksPerUs = clocktest::TIMER_HZ / 1000000;
+  // A dip is two rail edges during the watch window
+  const uint32_t dropouts = (refEdges[1] - refEdges[0] + 1) / 2;
+  if (offTicks == UINT32_MAX || offTicks > vcctest::OFF_LIMIT_US * ticksPerUs)
+    vccFailures |= VCC_FAIL_OFF;
+  if (onTicks == UINT32_MAX || onTicks > vcctest::ON_LIMIT_US * ticksPerUs)
+    vccFailures |= VCC_FAIL_ON;
+  if (dropouts)
+    vccFailures |= VCC_FAIL_DROPOUT;
+  engineOut.print("Master: VCC");
+  printVccTime("off_us", offTicks);
+  printVccTime("on_us", onTicks);
+  engineOut.print(" dropouts=");
+  engineOut.print(dropouts);
+  engineOut.print(" limit_off_us=");
+  engineOut.print(vcctest::OFF_LIMIT_US);
+  engineOut.print(" limit_on_us=");
+  engineOut.println(vcctest::ON_LIMIT_US);
+}
+
+// Test state machine: one pass over the current state.
+void engineStep(unsigned long now) {
+  // Pin levels of the current scan (TestPins bitmap)
+  uint32_t levels;
+
+  // XTALK between stages; not while pins are sampled on a schedule
+  if (xtalkRequested) {
+    xtalkRequested = false;
+    if (state == STATE_STANDALONE || state == STATE_MONITOR ||
+        (state == STATE_SEQUENCE && startSequenceRequested))
+      engineOut.println("Master: XTALK BUSY");
+    else
+      measureXtalk(xtalkAggressor);
+  }
+  if (clockRequested) {
+    uint8_t which = clockRequested;
+    clockRequested = 0;
+    if (state == STATE_STANDALONE || state == STATE_MONITOR ||
+        (state == STATE_SEQUENCE && startSequenceRequested))
+      engineOut.println("Master: CLOCK BUSY");
+    else
+      measureClock(which);
+  }
+  if (vccRequested) {
+    vccRequested = false;
+    if (state == STATE_STANDALONE || state == STATE_MONITOR ||
+        (state == STATE_SEQUENCE && startSequenceRequested))
+      engineOut.println("Master: VCC BUSY");
+    else
+      measureVcc();
+  }
+
+  switch (state) {
+  case STATE_HANDSHAKE:
+    break; // ui prints the hello beacon
 
   case STATE_WAIT_BUTTON: {
-    // Blinking indicates idle; awaiting button or START command
-    if (now - lastBlinkMs >= 500) {
-      Serial.println("Master: STAGE — IDLE: OK");
-      lastBlinkMs = now;
-      digitalWrite(LED_STATUS_PIN, !digitalRead(LED_STATUS_PIN));
-    }
-    if (pressed) {
-      while (digitalRead(BUTTON_PIN) == LOW) {
-        delay(10);
+    // Idle (ui blinks): awaiting button or START command
+    if (buttonPressed) {
+      buttonPressed = false;
+      engineOut.println("Master: BUTTON_PRESSED");
+      if (!hostAttached) {
+        startStandaloneRun(true);
+        break;
+      }
+    }
+    if (pollTargetSeated(now)) {
+      engineOut.println("Master: TARGET_SEATED");
+      if (!hostAttached) {
+        startStandaloneRun(false);
+        break;
       }
-      Serial.println("Master: BUTTON_PRESSED");
     }
     if (startRequested) {
       startRequested = false;
-      Serial.println("Master: START");
+      engineOut.println("Master: START");
+      runStartMs = now;
+      disarmSeat(now);
       precheckAllHighOk = false;
       precheckAllLowOk = false;
-      expectedIndex = 0;
+      highDefects = lowDefects = seqDefects = xtalkDefects = 0;
+      xtalkRan = false;
+      clockFailures = 0;
+      clockRan = false;
+      vccFailures = 0;
+      vccRan = false;
+      expectedIndex = nextActivePin(0);
       for (int i = 0; i < NUM_TEST_PINS; i++)
         pinWasHigh[i] = false;
-      digitalWrite(LED_STATUS_PIN, LOW);
+      LedStatus::low();
       beginAllHighPrinted = false;
       beginFailPrinted = false;
 
@@ -198,89 +1317,93 @@ void loop() {
   case STATE_WAIT_ALL_HIGH: {
     // Require: all dynamic lines HIGH (including VCC as a regular line)
     if (!beginAllHighPrinted) {
-      Serial.println("Master: STAGE — ALL_HIGH: AWAIT");
+      engineOut.println("Master: STAGE — ALL_HIGH: AWAIT");
       beginAllHighPrinted = true;
     }
 
     if (startAllHighRequested) {
       startAllHighRequested = false;
-      Serial.println("Master: STAGE — ALL_HIGH: BEGIN");
+      engineOut.println("Master: STAGE — ALL_HIGH: BEGIN");
+      traceEvent(engineOut, 'B', "check_all_high");
 
-      bool allHigh = true;
-      for (int i = 0; i < NUM_TEST_PINS; i++) {
-        currentLevels[i] = digitalRead(TEST_PINS[i]);
-        if (currentLevels[i] != HIGH)
-          allHigh = false;
-      }
+      levels = TestPins::read();
 
-      if (allHigh) {
-        Serial.println("Master: STAGE — ALL_HIGH: OK");
+      if ((levels & activeMask) == activeMask) {
+        engineOut.println("Master: STAGE — ALL_HIGH: OK");
         precheckAllHighOk = true;
         beginAllLowPrinted = false;
         toState(STATE_WAIT_ALL_LOW);
       } else {
-        Serial.print("Master: STAGE — ALL_HIGH: ERROR. LOW_PINS: ");
+        engineOut.print("Master: STAGE — ALL_HIGH: ERROR. LOW_PINS: ");
         bool first = true;
+        highDefects |= ~levels & activeMask;
         for (int i = 0; i < NUM_TEST_PINS; i++) {
-          if (currentLevels[i] == LOW) {
+          if ((activeMask & ~levels) & (1UL << i)) {
             if (!first)
-              Serial.print(", ");
-            Serial.print(TEST_LABELS[i]);
+              engineOut.print(", ");
+            engineOut.print(TEST_LABELS[i]);
             first = false;
           }
         }
-        Serial.println();
-        beginAllLowPrinted = false;
-        toState(STATE_WAIT_ALL_LOW); // continue test regardless
+        engineOut.println();
+        if (testMode == MODE_FAST) {
+          finishRun();
+        } else {
+          beginAllLowPrinted = false;
+          toState(STATE_WAIT_ALL_LOW); // FULL: continue to collect all defects
+        }
       }
+      traceEvent(engineOut, 'E', "check_all_high");
     }
   } break;
 
   case STATE_WAIT_ALL_LOW: {
     // Require: all dynamic lines LOW (including VCC as a regular line)
     if (!beginAllLowPrinted) {
-      Serial.println("Master: STAGE — ALL_LOW: AWAIT");
+      engineOut.println("Master: STAGE — ALL_LOW: AWAIT");
       beginAllLowPrinted = true;
     }
 
     if (startAllLowRequested) {
       startAllLowRequested = false;
-      Serial.println("Master: STAGE — ALL_LOW: BEGIN");
+      engineOut.println("Master: STAGE — ALL_LOW: BEGIN");
+      traceEvent(engineOut, 'B', "check_all_low");
 
-      bool allLow = true;
-      for (int i = 0; i < NUM_TEST_PINS; i++) {
-        currentLevels[i] = digitalRead(TEST_PINS[i]);
-        if (currentLevels[i] != LOW)
-          allLow = false;
-      }
+      levels = TestPins::read();
 
-      if (allLow) {
-        Serial.println("Master: STAGE — ALL_LOW: OK");
+      if ((levels & activeMask) == 0) {
+        engineOut.println("Master: STAGE — ALL_LOW: OK");
         precheckAllLowOk = true;
         beginSequencePrinted = false;
         toState(STATE_SEQUENCE);
       } else {
-        Serial.print("Master: STAGE — ALL_LOW: ERROR. HIGH_PINS: ");
+        engineOut.print("Master: STAGE — ALL_LOW: ERROR. HIGH_PINS: ");
         bool first = true;
+        lowDefects |= levels & activeMask;
         for (int i = 0; i < NUM_TEST_PINS; i++) {
-          if (currentLevels[i] == HIGH) {
+          if ((levels & activeMask) & (1UL << i)) {
             if (!first)
-              Serial.print(", ");
-            Serial.print(TEST_LABELS[i]);
+              engineOut.print(", ");
+            engineOut.print(TEST_LABELS[i]);
             first = false;
           }
         }
-        Serial.println();
-        beginSequencePrinted = false;
-        toState(STATE_SEQUENCE); // continue test regardless
+        engineOut.println();
+        if (testMode == MODE_FAST) {
+          finishRun();
+        } else {
+          beginSequencePrinted = false;
+          toState(STATE_SEQUENCE); // FULL: continue to collect all defects
+        }
       }
+      traceEvent(engineOut, 'E', "check_all_low");
     }
   } break;
 
   case STATE_SEQUENCE: {
     // Ensure exactly one pin goes HIGH at a time, in strict order
     if (!beginSequencePrinted) {
-      Serial.println("Master: STAGE — SEQUENCE: AWAIT");
+      engineOut.println("Master: STAGE — SEQUENCE: AWAIT");
       beginSequencePrinted = true;
       startSequenceRequested = false;
       nextPinRequested = false;
@@ -292,107 +1415,114 @@ void loop() {
 
     // Inside sequence: wait for NEXT_PIN command for each pin
     if (!nextPinRequested) {
-      static unsigned long lastAwaitPrint = 0;
-      if (now - lastAwaitPrint > 500) {
-        Serial.print("Master: STAGE — SEQUENCE: AWAIT_PIN — ");
-        Serial.println(TEST_LABELS[expectedIndex]);
-        lastAwaitPrint = now;
+      if (now - lastAwaitPrintMs > AWAIT_PIN_MS) {
+        engineOut.print("Master: STAGE — SEQUENCE: AWAIT_PIN — ");
+        engineOut.println(TEST_LABELS[expectedIndex]);
+        lastAwaitPrintMs = now;
       }
       break;
     }
 
-    // NEXT_PIN received: now we check if that pin went high
-    int highCount = 0;
-    int lastHighIdx = -1;
-    for (int i = 0; i < NUM_TEST_PINS; i++) {
-      currentLevels[i] = digitalRead(TEST_PINS[i]);
-      if (currentLevels[i] == HIGH) {
-        highCount++;
-        lastHighIdx = i;
-      }
-    }
+    // NEXT_PIN received: now we check if that pin went high. Lines outside the
+    // run's mask are not judged (unpopulated pads float)
+    levels = TestPins::read() & activeMask;
+    int highCount = __builtin_popcount(levels);
+    int lastHighIdx = levels ? 31 - __builtin_clz(levels) : -1;
 
     if (highCount > 1) {
-      Serial.print("Master: STAGE — SEQUENCE: ERROR. FAIL_PINS: ");
+      engineOut.print("Master: STAGE — SEQUENCE: ERROR. FAIL_PINS: ");
       bool first = true;
+      seqDefects |= levels;
       for (int i = 0; i < NUM_TEST_PINS; i++) {
-        if (currentLevels[i] == HIGH) {
+        if (levels & (1UL << i)) {
           if (!first)
-            Serial.print(", ");
-          Serial.print(TEST_LABELS[i]);
+            engineOut.print(", ");
+          engineOut.print(TEST_LABELS[i]);
           first = false;
         }
       }
-      Serial.println();
-      nextPinRequested = false;
-      startSequenceRequested = false;
-      toState(STATE_FAIL);
+      engineOut.println();
+      sequencePinFailed();
       break;
     }
 
     if (highCount == 1) {
       nextPinRequested = false; // consume command
-      Serial.print("Master: STAGE — SEQUENCE: OK — ");
-      Serial.println(TEST_LABELS[lastHighIdx]);
+      traceEvent(engineOut, 'I', "pin_high", TEST_LABELS[lastHighIdx]);
+      engineOut.print("Master: STAGE — SEQUENCE: OK — ");
+      engineOut.print(TEST_LABELS[lastHighIdx]);
+      engineOut.print(" settle_us=");
+      engineOut.println(micros() - pinStartUs); // NEXT_PIN to the pin read HIGH
 
       if (lastHighIdx == expectedIndex) {
-        expectedIndex++;
+        expectedIndex = nextActivePin(expectedIndex + 1);
         if (expectedIndex == NUM_TEST_PINS) {
-          Serial.println("Master: STAGE — SEQUENCE: ALL OK");
-          digitalWrite(LED_STATUS_PIN, HIGH);
-          startSequenceRequested = false;
-          toState(STATE_SUCCESS);
+          // FULL mode may reach the end with defects from earlier pins
+          engineOut.println(seqDefects ? "Master: STAGE — SEQUENCE: DONE"
+                                    : "Master: STAGE — SEQUENCE: ALL OK");
+          finishRun();
         }
       } else {
-        Serial.print("Master: STAGE — SEQUENCE: ERROR. THE ORDER OF SEQUENCE "
+        engineOut.print("Master: STAGE — SEQUENCE: ERROR. THE ORDER OF SEQUENCE "
                      "IS VIOLATED. EXPECTED: ");
-        Serial.print(TEST_LABELS[expectedIndex]);
-        Serial.print(", RECEIVED ");
-        Serial.println(TEST_LABELS[lastHighIdx]);
-        startSequenceRequested = false;
-        toState(STATE_FAIL);
+        engineOut.print(TEST_LABELS[expectedIndex]);
+        engineOut.print(", RECEIVED ");
+        engineOut.println(TEST_LABELS[lastHighIdx]);
+        seqDefects |= (1UL << expectedIndex) | (1UL << lastHighIdx);
+        sequencePinFailed();
       }
     } else {
-      // highCount == 0: wait or timeout
-      if (now - stateStartMs > 5000) { // 5s timeout per pin
-        Serial.print("Master: STAGE — SEQUENCE: ERROR. TIMEOUT. EXPECTED: ");
-        Serial.println(TEST_LABELS[expectedIndex]);
-        nextPinRequested = false;
-        startSequenceRequested = false;
-        toState(STATE_FAIL);
+      // highCount == 0: wait for the pin, timed from its NEXT_PIN
+      if (now - pinStartMs > PIN_TIMEOUT_MS) {
+        engineOut.print("Master: STAGE — SEQUENCE: ERROR. TIMEOUT. EXPECTED: ");
+        engineOut.println(TEST_LABELS[expectedIndex]);
+        seqDefects |= 1UL << expectedIndex;
+        sequencePinFailed();
       }
     }
   } break;
 
   case STATE_SUCCESS: {
     // Steady LED — success; wait for new button press
-    Serial.print("Master: STAGE — SUCCESS: OK\n");
+    engineOut.print("Master: STAGE — SUCCESS: OK\n");
     toState(STATE_WAIT_BUTTON);
   } break;
 
   case STATE_FAIL: {
-    // Fast blinking — failure; wait for button
+    // Fast blinking (ui) — failure; wait for button
     if (!beginFailPrinted) {
-      Serial.println("Master: FAIL");
+      engineOut.println("Master: FAIL");
       beginFailPrinted = true;
     }
-    if (now - lastBlinkMs >= 150) {
-      lastBlinkMs = now;
-      digitalWrite(LED_STATUS_PIN, !digitalRead(LED_STATUS_PIN));
-    }
-    if (pressed || startRequested) {
-      if (pressed) {
-        while (digitalRead(BUTTON_PIN) == LOW) {
-          delay(10);
-        }
+    if (pollTargetSeated(now)) {
+      engineOut.println("Master: TARGET_SEATED");
+      if (!hostAttached) {
+        startStandaloneRun(false);
+        break;
       }
+    }
+    if (buttonPressed && !hostAttached) {
+      buttonPressed = false;
+      startStandaloneRun(true);
+      break;
+    }
+    if (buttonPressed || startRequested) {
+      buttonPressed = false;
       startRequested = false;
-      Serial.println("Master: START");
+      engineOut.println("Master: START");
+      runStartMs = now;
+      disarmSeat(now);
       // pulseReset();
-      expectedIndex = 0;
+      expectedIndex = nextActivePin(0);
+      highDefects = lowDefects = seqDefects = xtalkDefects = 0;
+      xtalkRan = false;
+      clockFailures = 0;
+      clockRan = false;
+      vccFailures = 0;
+      vccRan = false;
       for (int i = 0; i < NUM_TEST_PINS; i++)
         pinWasHigh[i] = false;
-      digitalWrite(LED_STATUS_PIN, LOW);
+      LedStatus::low();
       // Reset preparatory flags and BEGIN markers
       precheckAllHighOk = false;
       precheckAllLowOk = false;
@@ -409,5 +1539,202 @@ void loop() {
       toState(STATE_WAIT_ALL_HIGH);
     }
   } break;
+
+  case STATE_MONITOR: {
+    // A button press or START ends the monitor; the run itself starts on the next request
+    if (buttonPressed || startRequested) {
+      buttonPressed = false;
+      startRequested = false;
+      engineOut.println("Master: MONITOR OFF");
+      toState(STATE_WAIT_BUTTON);
+      break;
+    }
+    levels = TestPins::read();
+    if (levels == monLevels && now - monReportMs < MONITOR_REFRESH_MS)
+      break;
+    // Only changes are sent; a change shorter than one poll period is not seen,
+    // and while USB backs up the engine blocks and reports the latest levels
+    monLevels = levels;
+    monReportMs = now;
+    engineOut.print("Master: MON ");
+    engineOut.print(micros() - monStartUs);
+    engineOut.print(' ');
+    engineOut.println(levels, HEX);
+  } break;
+
+  case STATE_STANDALONE: {
+    levels = TestPins::read();
+    if (!saSynced) {
+      // ALL_HIGH raises every line at once; the VCC beacon raises only one
+      if (__builtin_popcount(levels & ~saLastLevels) >= 2) {
+        saSynced = true;
+        saSyncMs = now;
+        setIdlePulls(false); // measure with plain inputs, as the host-paced stages do
+        engineOut.println("Master: STANDALONE SYNC");
+      } else if (now - stateStartMs > standalone::SYNC_TIMEOUT_MS) {
+        // No Target script: nothing was tested, so nothing is journaled
+        engineOut.println("Master: STANDALONE: ERROR. NO TARGET SCRIPT");
+        LedPcb::low();
+        beginFailPrinted = false;
+        toState(STATE_FAIL);
+      }
+      saLastLevels = levels;
+      break;
+    }
+    if (now - saSyncMs < standaloneSampleMs())
+      break;
+    if (saStep == 0) {
+      highDefects = ~levels & TestPins::all;
+    } else if (saStep == 1) {
+      lowDefects = levels;
+    } else if (levels != (1UL << (saStep - 2))) {
+      seqDefects |= (1UL << (saStep - 2)) | levels;
+    }
+    if (++saStep - 2 == NUM_TEST_PINS)
+      finishRun();
+  } break;
+  }
+}
+
+// How long the engine may sleep before its next deadline or poll
+TickType_t engineWaitTicks(unsigned long now) {
+  switch (state) {
+  case STATE_WAIT_BUTTON:
+  case STATE_FAIL:
+    return seatStableMs ? pdMS_TO_TICKS(SEAT_POLL_MS) : portMAX_DELAY;
+  case STATE_SEQUENCE:
+    if (!startSequenceRequested)
+      return portMAX_DELAY;
+    if (nextPinRequested)
+      return pdMS_TO_TICKS(PIN_POLL_MS); // sample until the pin shows or times out
+    if (now - lastAwaitPrintMs > AWAIT_PIN_MS)
+      return 0;
+    return pdMS_TO_TICKS(AWAIT_PIN_MS + 1 - (now - lastAwaitPrintMs));
+  case STATE_MONITOR:
+    return pdMS_TO_TICKS(MONITOR_POLL_MS);
+  case STATE_STANDALONE: {
+    if (!saSynced)
+      return pdMS_TO_TICKS(PIN_POLL_MS);
+    unsigned long due = saSyncMs + standaloneSampleMs();
+    return (long)(due - now) > 0 ? pdMS_TO_TICKS(due - now) : 0;
+  }
+  default:
+    return portMAX_DELAY;
+  }
+}
+
+// Highest priority: sleeps on engineQueue, so a command is acted on as soon
+// as the USB task posts it and pin sampling is not delayed by I/O or LEDs.
+void engineTask(void *) {
+  for (;;) {
+    EngineEvent ev;
+    if (xQueueReceive(engineQueue, &ev, engineWaitTicks(millis())) == pdTRUE)
+      applyEvent(ev);
+    // Run entry actions (AWAIT lines) of a new state right away
+    TestState before;
+    do {
+      before = state;
+      engineStep(millis());
+    } while (state != before);
+  }
+}
+
+// Lowest priority: button debounce, status LED and heartbeat lines.
+void uiTask(void *) {
+  TickType_t wake = xTaskGetTickCount();
+  unsigned long lastBlinkMs = 0;
+  unsigned long lastButtonEdgeMs = 0;
+  bool lastButtonState = HIGH; // INPUT_PULLUP
+  bool held = false;           // debounced press, reported on release
+  for (;;) {
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(UI_PERIOD_MS));
+    unsigned long now = millis();
+
+    // Button handling with debouncing
+    bool btn = Button::read();
+    if (btn != lastButtonState) {
+      lastButtonEdgeMs = now;
+      lastButtonState = btn;
+    }
+    if (now - lastButtonEdgeMs > DEBOUNCE_MS) {
+      if (btn == LOW) {
+        held = true;
+      } else if (held) {
+        held = false;
+        postEvent(EV_BUTTON);
+      }
+    }
+
+    // Journal: finished runs, host requests and batched flash writes
+    journal::Record rec;
+    while (xQueueReceive(journalQueue, &rec, 0) == pdTRUE)
+      journal::add(rec);
+    if (journalRequest == JR_DUMP) {
+      journal::dump(uiOut, TEST_LABELS);
+      journalRequest = JR_NONE;
+    } else if (journalRequest == JR_CLEAR) {
+      journal::clear();
+      uiOut.println("Master: JOURNAL CLEARED");
+      journalRequest = JR_NONE;
+    }
+    journal::poll(now, state == STATE_HANDSHAKE || state == STATE_WAIT_BUTTON || state == STATE_FAIL);
+
+    switch (state) {
+    case STATE_HANDSHAKE:
+      if (now - lastBlinkMs >= 200) {
+        uiOut.println("Hello! I am Master!");
+        lastBlinkMs = now;
+        LedStatus::toggle();
+      }
+      break;
+    case STATE_WAIT_BUTTON:
+      // Standalone: a pass stays lit until the next run
+      if (!hostAttached && lastRunPassed) {
+        LedStatus::high();
+        break;
+      }
+      // Blinking indicates idle
+      if (now - lastBlinkMs >= 500) {
+        uiOut.println("Master: STAGE — IDLE: OK");
+        lastBlinkMs = now;
+        LedStatus::toggle();
+      }
+      break;
+    case STATE_FAIL:
+      // Fast blinking — failure
+      if (now - lastBlinkMs >= 150) {
+        lastBlinkMs = now;
+        LedStatus::toggle();
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+// Write queued output of one producer; a split line is written whole.
+void drainTx(QueueHandle_t queue) {
+  TxChunk chunk;
+  while (xQueueReceive(queue, &chunk, 0) == pdTRUE) {
+    Serial.write((const uint8_t *)chunk.text, chunk.len);
+    while (chunk.more && xQueueReceive(queue, &chunk, portMAX_DELAY) == pdTRUE)
+      Serial.write((const uint8_t *)chunk.text, chunk.len);
+  }
+}
+
+// USB I/O task: sleeps until a producer queues output or the RX poll period
+// ends, then writes pending lines and handles every buffered command.
+void loop() {
+  static bool host = true;
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(USB_POLL_MS));
+  if ((bool)Serial != host) { // DTR: the app opened or closed the port
+    host = !host;
+    postEvent(EV_HOST, host);
   }
+  drainTx(engineTx);
+  drainTx(uiTx);
+  const char *cmd;
+  while ((cmd = readCommand()) != nullptr)
+    handleCommand(cmd);
 }
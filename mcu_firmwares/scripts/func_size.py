@@ -0,0 +1,98 @@
+"""Code size and instruction count of the GPIO-heavy firmware functions.
+
+As a PlatformIO extra script it adds a `funcsize` target:
+
+    pio run -t funcsize
+
+It can also be run directly on an ELF:
+
+    python func_size.py .pio/build/supermini/firmware.elf [objdump]
+
+For every function whose name matches FUNCTIONS it prints the code bytes and
+the instruction count from the disassembly. The results are
+saved next to the ELF as `funcsize.json`, and the next run shows the change,
+so a GPIO refactor or a regression shows up as a number per function.
+"""
+import json
+import os
+import re
+import subprocess
+import sys
+
+# Functions that touch the test pins (substring match on demangled names)
+FUNCTIONS = ("setAll", "engineStep", "targetPresent", "setIdlePulls", "pollTargetSeated",
+             "uiTask", "setup", "loop")
+
+_FUNC_RE = re.compile(r"^[0-9a-f]+ <(.+)>:$")
+_INSN_RE = re.compile(r"^\s+[0-9a-f]+:\t([0-9a-f ]+)\t")
+
+
+def count_instructions(elf: str, objdump: str) -> dict[str, list[int]]:
+    """Return {function: [bytes, instructions]} for the matching functions."""
+    out = subprocess.run([objdump, "-d", "-C", elf], capture_output=True, text=True, check=True).stdout
+    result: dict[str, list[int]] = {}
+    current = None
+    for line in out.splitlines():
+        m = _FUNC_RE.match(line)
+        if m:
+            current = m.group(1) if any(f in m.group(1) for f in FUNCTIONS) else None
+            if current:
+                result[current] = [0, 0]
+            continue
+        m = _INSN_RE.match(line) if current else None
+        if m:
+            result[current][0] += len(m.group(1).replace(" ", "")) // 2
+            result[current][1] += 1
+    return result
+
+
+def report(elf: str, objdump: str = "arm-none-eabi-objdump") -> int:
+    if not os.path.exists(elf):
+        print(f"func_size: {elf} not found, build first")
+        return 1
+    funcs = count_instructions(elf, objdump)
+    json_path = os.path.join(os.path.dirname(elf), "funcsize.json")
+    previous = {}
+    if os.path.exists(json_path):
+        try:
+            with open(json_path, encoding="utf-8") as f:
+                previous = json.load(f)
+        except (OSError, ValueError):
+            previous = {}
+
+    def delta(name, idx, value):
+        old = previous.get(name)
+        if old is None:
+            return ""
+        d = value - old[idx]
+        return f"{d:+d}" if d else ""
+
+    print(f"{'function':<48} {'bytes':>7} {'Δ':>7} {'insns':>7} {'Δ':>7}")
+    for name, (size, insns) in sorted(funcs.items(), key=lambda kv: kv[1][0], reverse=True):
+        print(f"{name[:48]:<48} {size:>7} {delta(name, 0, size):>7} {insns:>7} {delta(name, 1, insns):>7}")
+
+    with open(json_path, "w", encoding="utf-8") as f:
+        json.dump(funcs, f, indent=1, sort_keys=True)
+    return 0
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(2)
+    sys.exit(report(sys.argv[1], *sys.argv[2:3]))
+else:
+    try:
+        Import("env")  # noqa: F821 — provided by PlatformIO/SCons
+    except NameError:
+        env = None
+    if env is not None:
+        script = os.path.join(env.subst("$PROJECT_DIR"), "..", "scripts", "func_size.py")
+        objdump = env.subst("$OBJCOPY").replace("objcopy", "objdump")
+        env.AddCustomTarget(
+            name="funcsize",
+            dependencies="$BUILD_DIR/${PROGNAME}.elf",
+            actions=[f'"$PYTHONEXE" "{script}" "$BUILD_DIR/${{PROGNAME}}.elf" "{objdump}"'],
+            title="Function size",
+            description="Bytes and instructions of the GPIO-heavy functions",
+        )
@@ -0,0 +1,152 @@
+"""Flash/RAM usage per symbol group, from the GNU ld map file.
+
+As a PlatformIO extra script it makes the linker write `firmware.map` and adds
+a `memreport` target:
+
+    pio run -t memreport
+
+It can also be run directly on a map file:
+
+    python mem_report.py .pio/build/supermini/firmware.map
+
+Input sections are grouped by what contributed them: each file under `src/`,
+each library and each toolchain archive (libc, libgcc, ...). The totals are
+saved next to the map as `memreport.json`; on the next run the report shows
+the change per group, so a memory regression shows up as a number.
+"""
+import json
+import os
+import re
+import sys
+
+# Output sections that occupy flash (.data is copied from flash at boot) and RAM
+FLASH_SECTIONS = (".text", ".ARM.extab", ".ARM.exidx", ".rodata", ".data", ".fs_data", ".svc_data")
+RAM_SECTIONS = (".data", ".bss", ".noinit", ".heap", ".stack_dummy", ".svc_data")
+
+_OUTPUT_RE = re.compile(r"^(\.[\w.]+)\s+0x[0-9a-fA-F]+\s+0x[0-9a-fA-F]+")
+_INPUT_RE = re.compile(r"^ (?:\*\(.*\)\s*)?(\.[^\s]+)?\s*0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+_REGION_RE = re.compile(r"^(\w+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+
+
+def _group(obj_path: str) -> str:
+    path = obj_path.replace("\\", "/")
+    if "(" in path:  # archive member: /path/libfoo.a(bar.o)
+        return os.path.basename(path.split("(", 1)[0])
+    parts = path.split("/")
+    if "build" in parts:
+        rest = parts[parts.index("build") + 2:]  # skip .pio/build/<env>/
+        if rest and rest[0] == "src":
+            return "/".join(rest)[:-2] if path.endswith(".o") else "/".join(rest)
+        if rest:
+            return rest[0]
+    return os.path.basename(path)
+
+
+def parse_map(path: str):
+    """Return ({group: [flash, ram]}, {region: length})."""
+    groups: dict[str, list[int]] = {}
+    regions: dict[str, int] = {}
+    section = None
+    in_regions = False
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for raw in f:
+            line = raw.rstrip("\n")
+            if line.startswith("Memory Configuration"):
+                in_regions = True
+                continue
+            if in_regions:
+                if line.startswith("Linker script and memory map"):
+                    in_regions = False
+                m = _REGION_RE.match(line)
+                if m and m.group(1) != "Name":
+                    regions[m.group(1)] = int(m.group(3), 16)
+                continue
+            m = _OUTPUT_RE.match(line)
+            if m:
+                section = m.group(1)
+                continue
+            if line and not line[0].isspace():
+                section = line.split()[0] if line.startswith(".") else None
+                continue
+            if section is None:
+                continue
+            # Input sections; long names put address and size on the next line
+            m = _INPUT_RE.match(line)
+            if not m or "*fill*" in line:
+                continue
+            size = int(m.group(3), 16)
+            obj = m.group(4).strip()
+            if size == 0 or obj.startswith("0x"):
+                continue
+            g = groups.setdefault(_group(obj), [0, 0])
+            if section in FLASH_SECTIONS:
+                g[0] += size
+            if section in RAM_SECTIONS:
+                g[1] += size
+    return groups, regions
+
+
+def report(map_path: str, top: int = 25) -> int:
+    if not os.path.exists(map_path):
+        print(f"mem_report: {map_path} not found, build first")
+        return 1
+    groups, regions = parse_map(map_path)
+    json_path = os.path.join(os.path.dirname(map_path), "memreport.json")
+    previous = {}
+    if os.path.exists(json_path):
+        try:
+            with open(json_path, encoding="utf-8") as f:
+                previous = json.load(f)
+        except (OSError, ValueError):
+            previous = {}
+
+    def delta(name, idx, value):
+        old = previous.get(name)
+        if old is None:
+            return ""
+        d = value - old[idx]
+        return f"{d:+d}" if d else ""
+
+    total_flash = sum(g[0] for g in groups.values())
+    total_ram = sum(g[1] for g in groups.values())
+    print(f"{'group':<40} {'flash':>8} {'Δ':>7} {'ram':>8} {'Δ':>7}")
+    ordered = sorted(((k, g) for k, g in groups.items() if g[0] or g[1]),
+                     key=lambda kv: (kv[1][0] + kv[1][1]), reverse=True)
+    for name, (flash, ram) in ordered[:top]:
+        print(f"{name:<40} {flash:>8} {delta(name, 0, flash):>7} {ram:>8} {delta(name, 1, ram):>7}")
+    if len(ordered) > top:
+        rest_flash = sum(g[0] for _, g in ordered[top:])
+        rest_ram = sum(g[1] for _, g in ordered[top:])
+        print(f"{f'({len(ordered) - top} more)':<40} {rest_flash:>8} {'':>7} {rest_ram:>8}")
+    prev_flash = sum(g[0] for g in previous.values()) if previous else total_flash
+    prev_ram = sum(g[1] for g in previous.values()) if previous else total_ram
+    print(f"{'TOTAL':<40} {total_flash:>8} {total_flash - prev_flash:>+7} {total_ram:>8} {total_ram - prev_ram:>+7}")
+    for region, used in (("FLASH", total_flash), ("RAM", total_ram)):
+        if regions.get(region):
+            print(f"{region}: {used} / {regions[region]} bytes ({100.0 * used / regions[region]:.1f}%)")
+
+    with open(json_path, "w", encoding="utf-8") as f:
+        json.dump(groups, f, indent=1, sort_keys=True)
+    return 0
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(2)
+    sys.exit(report(sys.argv[1]))
+else:
+    try:
+        Import("env")  # noqa: F821 — provided by PlatformIO/SCons
+    except NameError:
+        env = None
+    if env is not None:
+        script = os.path.join(env.subst("$PROJECT_DIR"), "..", "scripts", "mem_report.py")
+        env.Append(LINKFLAGS=["-Wl,-Map,${BUILD_DIR}/firmware.map"])
+        env.AddCustomTarget(
+            name="memreport",
+            dependencies="$BUILD_DIR/${PROGNAME}.elf",
+            actions=[f'"$PYTHONEXE" "{script}" "$BUILD_DIR/firmware.map"'],
+            title="Memory report",
+            description="Flash/RAM usage per symbol group",
+        )
@@ -6,33 +6,515 @@
  * 2) ALL_LOW  — drive all pins LOW.
  * 3) SEQUENCE — toggle each pin HIGH/LOW.
  *
- * Each stage is triggered by an app command.
+ * Each stage is triggered by an app command. Without a USB host the Target
+ * plays the standalone script of include/standalone.h once after boot.
+ *
+ * XTALK toggles one aggressor line (or all lines at once) from a hardware
+ * timer while the Master counts coupled glitches on the quiet lines. CLOCK
+ * outputs a square wave timed by the HF or LF crystal for the Master to
+ * measure (include/clock_test.h).
  */
 #include <Adafruit_TinyUSB.h>
 #include <Arduino.h>
 #include <MiniShell.h>
+#include <malloc.h>
+
+#include "board_profile.h"
+#include "clock_test.h"
+#include "fast_gpio.h"
+#include "standalone.h"
+#include "vcc_test.h"
+
+using fastgpio::Pin;
 
-#define LED_STATUS_PIN P0_15 // status LED
-#define VCC_CTRL_PIN P0_13   // Target controls external power
+using LedStatus = Pin<0, 15>;               // status LED
+using VccCtrl = board::Profile::VccCtrl; // Target controls external power
 
-// Dynamic lines (exact same order as Master TEST_PINS)
-const int TEST_PINS[] = {VCC_CTRL_PIN, // P0_13 (VCC)
-                         P0_31,        P0_29, P0_02, P1_15, P1_13, P1_11,
-                         P0_10,        P0_09, P1_06, P1_04, P0_11, P1_00,
-                         P0_24,        P0_22, P0_20, P0_17, P0_08, P0_06};
-const int NUM_TEST_PINS = sizeof(TEST_PINS) / sizeof(TEST_PINS[0]);
+// Dynamic lines from the board profile (exact same order as Master TestPins)
+using TestPins = board::Profile::TargetPins;
+const int NUM_TEST_PINS = board::NUM_TEST_PINS;
 
 // Protocol timings
 const int SEQ_MS = 150; // duration for each pin in sequence
 
-enum State { STATE_HANDSHAKE, STATE_IDLE };
+// HELLO? descriptor: protocol version and feature bits (see app/descriptor.py)
+#ifndef FW_BUILD
+#define FW_BUILD 0 // set by platformio.ini (build time)
+#endif
+const int PROTO_VERSION = 2;
+const uint32_t FEAT_STAGES = 1UL << 0;     // ALL_HIGH / ALL_LOW / SEQUENCE
+const uint32_t FEAT_TRACE = 1UL << 1;      // TRACE ON/OFF, TIMESYNC
+const uint32_t FEAT_MEM = 1UL << 2;        // MEM
+const uint32_t FEAT_LINK_PROBE = 1UL << 3; // PING, BLAST
+const uint32_t FEAT_MODES = 1UL << 4;      // START FAST|FULL, RESULT line
+const uint32_t FEAT_AUTOSTART = 1UL << 5;  // AUTOSTART, TARGET_SEATED
+const uint32_t FEAT_PIN_ACK = 1UL << 6;    // PIN_UP once a SEQUENCE pin is raised
+const uint32_t FEAT_STANDALONE = 1UL << 7; // PC-less script after boot
+const uint32_t FEAT_XTALK = 1UL << 8;      // XTALK <i>|ALL|STOP aggressor toggling
+const uint32_t FEAT_CLOCK = 1UL << 9;      // CLOCK HF|LF|STOP crystal-timed square wave
+const uint32_t FEAT_ID = 1UL << 10;        // ID? board identity from FICR/UICR
+const uint32_t FEAT_PIN_MASK = 1UL << 11;  // START_ALL_HIGH|START_SEQUENCE <mask> drive only those pins
+const uint32_t FEAT_MONITOR = 1UL << 12;   // HOLD <mask> keeps a static pattern for the monitor
+const uint32_t FEAT_VCC = 1UL << 13;       // VCC CYCLE switches the external power on a fixed script
+
+// Hardware toggling (XTALK, CLOCK): a peripheral event toggles one test line
+// without the CPU (event -> PPI -> GPIOTE TASKS_OUT). TIMER2 runs at 16 MHz;
+// XTALK ALL switches every line but VCC together from the TIMER2 interrupt,
+// one store per port (simultaneous switching noise). The SoftDevice is never
+// enabled here, so TIMER2, RTC2, PPI and GPIOTE are this firmware's own.
+const uint32_t XTALK_ONE_TICKS = 32;  // 250 kHz square wave on one aggressor
+const uint32_t XTALK_ALL_TICKS = 160; // 50 kHz on all lines (interrupt load)
+const int TOGGLE_PPI_CH = 0;
+const int TOGGLE_GPIOTE_CH = 0;
+const int XTALK_ALL = -1;
+
+enum State { STATE_HANDSHAKE, STATE_IDLE, STATE_STANDALONE };
 
 State state = STATE_HANDSHAKE;
 unsigned long lastBlinkMs = 0;
+bool traceEnabled = false; // timeline trace output (TRACE ON/OFF)
+
+// Standalone script: start time and the phase applied last
+// (0 lead, 1 ALL_HIGH, 2 ALL_LOW, 3 + i SEQUENCE pin i, 3 + NUM_TEST_PINS done)
+unsigned long saStartMs = 0;
+int saPhase = -1;
+
+// Hardware toggling in progress (XTALK or CLOCK)
+bool toggleActive = false;
+volatile bool xtalkPhase = false; // XTALK ALL: level of the next edge
+
+// Serial command line buffer (static: no heap use in the command path)
+const size_t CMD_BUF_LEN = 128;
+char cmdBuf[CMD_BUF_LEN];
+size_t cmdLen = 0;
+bool cmdOverflow = false;
+
+// BLAST line filler (link throughput probe)
+const size_t BLAST_MAX_SIZE = 256;
+char blastFill[BLAST_MAX_SIZE];
+
+// Heap bounds from the nRF52 linker script
+extern "C" char __HeapBase, __HeapLimit;
+
+// Emit a timestamped trace event: "Target: TRACE <micros> <B|E|I> <name> [arg]"
+void traceEvent(char phase, const char *name, int arg = -1) {
+  if (!traceEnabled)
+    return;
+  Serial.print("Target: TRACE ");
+  Serial.print(micros());
+  Serial.print(' ');
+  Serial.print(phase);
+  Serial.print(' ');
+  Serial.print(name);
+  if (arg >= 0) {
+    Serial.print(' ');
+    Serial.print(arg);
+  }
+  Serial.println();
+}
+
+// Collect pending serial bytes without blocking. Returns the trimmed command
+// once a full line is buffered, nullptr otherwise. Over-long lines are dropped.
+const char *readCommand() {
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c != '\n') {
+      if (cmdLen < CMD_BUF_LEN - 1)
+        cmdBuf[cmdLen++] = c;
+      else
+        cmdOverflow = true;
+      continue;
+    }
+    cmdBuf[cmdLen] = '\0';
+    bool dropped = cmdOverflow;
+    cmdLen = 0;
+    cmdOverflow = false;
+    if (dropped)
+      continue;
+    char *s = cmdBuf;
+    while (isspace((unsigned char)*s))
+      s++;
+    char *e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1]))
+      *--e = '\0';
+    return s;
+  }
+  return nullptr;
+}
+
+// Report memory headroom:
+//   "Target: MEM HEAP used=<b> peak=<b> size=<b>"
+//   "Target: MEM STACK <task> free=<b>" for each FreeRTOS task
+//   "Target: MEM END"
+// peak is the heap arena newlib has claimed so far (its high-water mark);
+// free is the least stack a task has ever had left.
+void reportMemory() {
+  struct mallinfo mi = mallinfo();
+  Serial.print("Target: MEM HEAP used=");
+  Serial.print((unsigned long)mi.uordblks);
+  Serial.print(" peak=");
+  Serial.print((unsigned long)mi.arena);
+  Serial.print(" size=");
+  Serial.println((unsigned long)(&__HeapLimit - &__HeapBase));
+
+  UBaseType_t n = 0;
+#if configUSE_TRACE_FACILITY
+  static TaskStatus_t tasks[16];
+  n = uxTaskGetSystemState(tasks, sizeof(tasks) / sizeof(tasks[0]), nullptr);
+  for (UBaseType_t i = 0; i < n; i++) {
+    Serial.print("Target: MEM STACK ");
+    Serial.print(tasks[i].pcTaskName);
+    Serial.print(" free=");
+    Serial.println((unsigned long)(tasks[i].usStackHighWaterMark * sizeof(StackType_t)));
+  }
+#endif
+  if (n == 0) { // no task list available: report the loop task only
+    Serial.print("Target: MEM STACK ");
+    Serial.print(pcTaskGetName(nullptr));
+    Serial.print(" free=");
+    Serial.println((unsigned long)(uxTaskGetStackHighWaterMark(nullptr) * sizeof(StackType_t)));
+  }
+  Serial.println("Target: MEM END");
+}
+
+// PING <seq> [payload]: echo at once with the device clock for RTT/jitter:
+//   "Target: PONG <seq> <micros> [payload]"
+void handlePing(const char *args) {
+  unsigned long t = micros();
+  char *rest;
+  unsigned long seq = strtoul(args, &rest, 10);
+  while (*rest == ' ')
+    rest++;
+  Serial.print("Target: PONG ");
+  Serial.print(seq);
+  Serial.print(' ');
+  Serial.print(t);
+  if (*rest) {
+    Serial.print(' ');
+    Serial.print(rest);
+  }
+  Serial.println();
+}
+
+// BLAST <n> <size>: stream n lines of <size> filler bytes for throughput:
+//   "Target: BLAST <i> <micros> ....", then "Target: BLAST_END <n> <elapsed_us>"
+void handleBlast(const char *args) {
+  char *rest;
+  unsigned long n = strtoul(args, &rest, 10);
+  unsigned long size = strtoul(rest, nullptr, 10);
+  if (size > BLAST_MAX_SIZE)
+    size = BLAST_MAX_SIZE;
+  if (blastFill[0] != '.')
+    memset(blastFill, '.', sizeof(blastFill));
+  unsigned long t0 = micros();
+  for (unsigned long i = 0; i < n; i++) {
+    Serial.print("Target: BLAST ");
+    Serial.print(i);
+    Serial.print(' ');
+    Serial.print(micros());
+    Serial.print(' ');
+    Serial.write((const uint8_t *)blastFill, size);
+    Serial.println();
+  }
+  Serial.print("Target: BLAST_END ");
+  Serial.print(n);
+  Serial.print(' ');
+  Serial.println(micros() - t0);
+}
+
+// Answer HELLO? with a one-line descriptor:
+//   "Target: DESC proto=<n> build=<id> profile=<name> pins=<n> pinhash=<hex> features=0x<hex> <timings>"
+void printDescriptor() {
+  Serial.print("Target: DESC proto=");
+  Serial.print(PROTO_VERSION);
+  Serial.print(" build=");
+  Serial.print((unsigned long)FW_BUILD);
+  Serial.print(" profile=");
+  Serial.print(board::Profile::NAME);
+  Serial.print(" pins=");
+  Serial.print(NUM_TEST_PINS);
+  Serial.print(" pinhash=");
+  Serial.print((unsigned long)board::PIN_MAP_HASH, HEX);
+  Serial.print(" features=0x");
+  Serial.print((unsigned long)(FEAT_STAGES | FEAT_TRACE | FEAT_MEM | FEAT_LINK_PROBE | FEAT_PIN_ACK |
+                               FEAT_STANDALONE | FEAT_XTALK | FEAT_CLOCK | FEAT_ID |
+                               FEAT_PIN_MASK | FEAT_MONITOR | FEAT_VCC), HEX);
+  Serial.print(" seq_ms=");
+  Serial.print(SEQ_MS);
+  Serial.println();
+}
+
+// Zero-padded hex: the IDs are compared as strings by the app
+void printHex(uint32_t value, int digits) {
+  for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4)
+    Serial.print((value >> shift) & 0xF, HEX);
+}
+
+// Answer ID? with the board identity, one line:
+//   "Target: ID devid=<16 hex> addr=<12 hex> addrtype=pub|rnd part=<hex> variant=<4 chars>
+//    flash_kb=<n> ram_kb=<n> bl=<hex start>|none"
+// devid is the factory-programmed 64-bit FICR DEVICEID, unique per chip. bl is
+// the bootloader start address from UICR NRFFW[0] (erased: no bootloader).
+void printIdentity() {
+  Serial.print("Target: ID devid=");
+  printHex(NRF_FICR->DEVICEID[1], 8);
+  printHex(NRF_FICR->DEVICEID[0], 8);
+  Serial.print(" addr=");
+  printHex(NRF_FICR->DEVICEADDR[1] & 0xFFFF, 4);
+  printHex(NRF_FICR->DEVICEADDR[0], 8);
+  Serial.print((NRF_FICR->DEVICEADDRTYPE & 1) ? " addrtype=rnd" : " addrtype=pub");
+  Serial.print(" part=");
+  Serial.print((unsigned long)NRF_FICR->INFO.PART, HEX);
+  Serial.print(" variant=");
+  uint32_t variant = NRF_FICR->INFO.VARIANT; // ASCII, e.g. "AAD0"
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    char c = (char)(variant >> shift);
+    Serial.print(c >= 0x21 && c <= 0x7E ? c : '?');
+  }
+  Serial.print(" flash_kb=");
+  Serial.print((unsigned long)NRF_FICR->INFO.FLASH);
+  Serial.print(" ram_kb=");
+  Serial.print((unsigned long)NRF_FICR->INFO.RAM);
+  Serial.print(" bl=");
+  uint32_t bl = NRF_UICR->NRFFW[0];
+  if (bl == 0xFFFFFFFF)
+    Serial.print("none");
+  else
+    Serial.print((unsigned long)bl, HEX);
+  Serial.println();
+}
+
+// One OUTSET/OUTCLR store per port
+void setAll(int level) { TestPins::write(level); }
+
+// XTALK ALL edge: the test lines except VCC, one OUTSET/OUTCLR per port
+extern "C" void TIMER2_IRQHandler(void) {
+  constexpr uint32_t m0 = TestPins::portMask<0>() & ~(VccCtrl::port == 0 ? VccCtrl::mask : 0);
+  constexpr uint32_t m1 = TestPins::portMask<1>() & ~(VccCtrl::port == 1 ? VccCtrl::mask : 0);
+  NRF_TIMER2->EVENTS_COMPARE[0] = 0;
+  xtalkPhase = !xtalkPhase;
+  if (xtalkPhase) {
+    NRF_P0->OUTSET = m0;
+    NRF_P1->OUTSET = m1;
+  } else {
+    NRF_P0->OUTCLR = m0;
+    NRF_P1->OUTCLR = m1;
+  }
+}
+
+// Stop any hardware toggling and return to the idle stage levels (all LOW outputs)
+void toggleStop() {
+  NRF_TIMER2->TASKS_STOP = 1;
+  NRF_TIMER2->INTENCLR = TIMER_INTENCLR_COMPARE0_Msk;
+  NVIC_DisableIRQ(TIMER2_IRQn);
+  NRF_RTC2->TASKS_STOP = 1;
+  NRF_RTC2->EVTENCLR = RTC_EVTEN_TICK_Msk;
+  NRF_PPI->CHENCLR = 1UL << TOGGLE_PPI_CH;
+  NRF_GPIOTE->CONFIG[TOGGLE_GPIOTE_CH] = 0; // the pin returns to its PIN_CNF/OUT
+  setAll(LOW);
+  TestPins::mode(fastgpio::Output);
+  toggleActive = false;
+}
 
-void setAll(int level) {
-  for (int i = 0; i < NUM_TEST_PINS; i++) {
-    digitalWrite(TEST_PINS[i], level);
+// Toggle test line i on every `event` (GPIOTE owns the pin, starting LOW)
+void routeToggle(int i, volatile uint32_t *event) {
+  NRF_GPIOTE->CONFIG[TOGGLE_GPIOTE_CH] =
+      (GPIOTE_CONFIG_MODE_Task << GPIOTE_CONFIG_MODE_Pos) |
+      ((uint32_t)(TestPins::numbers[i] & 31) << GPIOTE_CONFIG_PSEL_Pos) |
+      ((uint32_t)TestPins::ports[i] << GPIOTE_CONFIG_PORT_Pos) |
+      (GPIOTE_CONFIG_POLARITY_Toggle << GPIOTE_CONFIG_POLARITY_Pos) |
+      (GPIOTE_CONFIG_OUTINIT_Low << GPIOTE_CONFIG_OUTINIT_Pos);
+  NRF_PPI->CH[TOGGLE_PPI_CH].EEP = (uint32_t)event;
+  NRF_PPI->CH[TOGGLE_PPI_CH].TEP = (uint32_t)&NRF_GPIOTE->TASKS_OUT[TOGGLE_GPIOTE_CH];
+  NRF_PPI->CHENSET = 1UL << TOGGLE_PPI_CH;
+}
+
+// TIMER2 at 16 MHz, COMPARE[0] every `ticks` (cleared by the shortcut)
+void startTimer2(uint32_t ticks) {
+  NRF_TIMER2->TASKS_CLEAR = 1;
+  NRF_TIMER2->MODE = TIMER_MODE_MODE_Timer;
+  NRF_TIMER2->BITMODE = TIMER_BITMODE_BITMODE_16Bit;
+  NRF_TIMER2->PRESCALER = 0;
+  NRF_TIMER2->SHORTS = TIMER_SHORTS_COMPARE0_CLEAR_Msk;
+  NRF_TIMER2->CC[0] = ticks;
+  NRF_TIMER2->EVENTS_COMPARE[0] = 0;
+  NRF_TIMER2->TASKS_START = 1;
+}
+
+// XTALK <i>|ALL: release the quiet lines to the Master's pull-downs, keep VCC
+// HIGH (the Master watches it for supply dips) and start toggling.
+// Acks "Target: XTALK_UP <i>|ALL" once the edges run.
+void xtalkStart(int aggressor) {
+  toggleStop();
+  if (aggressor == XTALK_ALL) {
+    VccCtrl::high();
+    xtalkPhase = false;
+    NRF_TIMER2->INTENSET = TIMER_INTENSET_COMPARE0_Msk;
+    NVIC_SetPriority(TIMER2_IRQn, 3);
+    NVIC_ClearPendingIRQ(TIMER2_IRQn);
+    NVIC_EnableIRQ(TIMER2_IRQn);
+    startTimer2(XTALK_ALL_TICKS);
+  } else {
+    TestPins::mode(fastgpio::Input);
+    VccCtrl::mode(fastgpio::Output);
+    VccCtrl::high();
+    routeToggle(aggressor, &NRF_TIMER2->EVENTS_COMPARE[0]);
+    startTimer2(XTALK_ONE_TICKS);
+  }
+  toggleActive = true;
+
+  Serial.print("Target: XTALK_UP ");
+  if (aggressor == XTALK_ALL)
+    Serial.println("ALL");
+  else
+    Serial.println(aggressor);
+}
+
+// XTALK <i>|ALL|STOP. VCC (index 0) switches the external power and is never
+// an aggressor. Unknown arguments answer "Target: XTALK_REJECTED <arg>".
+void handleXtalk(const char *arg) {
+  if (strcasecmp(arg, "STOP") == 0) {
+    toggleStop();
+    Serial.println("Target: XTALK_DONE");
+    return;
+  }
+  if (strcasecmp(arg, "ALL") == 0) {
+    xtalkStart(XTALK_ALL);
+    return;
+  }
+  char *end;
+  long i = strtol(arg, &end, 10);
+  if (end != arg && *end == '\0' && i >= 1 && i < NUM_TEST_PINS) {
+    xtalkStart((int)i);
+    return;
+  }
+  Serial.print("Target: XTALK_REJECTED ");
+  Serial.println(arg);
+}
+
+// CLOCK HF|LF|STOP: square wave on test line clocktest::PIN_INDEX, HF from
+// TIMER2 on the HFXO, LF from the RTC2 TICK on the LFCLK. Acks
+//   "Target: CLOCK_UP HF" / "Target: CLOCK_UP LF src=<XTAL|RC|SYNTH>"
+// (an LFCLK that is not the crystal is measured all the same), then
+// "Target: CLOCK_DONE" on STOP.
+void handleClock(const char *arg) {
+  if (strcasecmp(arg, "STOP") == 0) {
+    toggleStop();
+    Serial.println("Target: CLOCK_DONE");
+    return;
+  }
+  bool hf = strcasecmp(arg, "HF") == 0;
+  if (!hf && strcasecmp(arg, "LF") != 0) {
+    Serial.print("Target: CLOCK_REJECTED ");
+    Serial.println(arg);
+    return;
+  }
+  toggleStop();
+  if (hf) {
+    clocktest::startHfxo();
+    routeToggle(clocktest::PIN_INDEX, &NRF_TIMER2->EVENTS_COMPARE[0]);
+    startTimer2(clocktest::hfHalfPeriodTicks());
+    Serial.println("Target: CLOCK_UP HF");
+  } else {
+    // The core keeps LFCLK running for the FreeRTOS tick (RTC1)
+    NRF_RTC2->TASKS_CLEAR = 1;
+    NRF_RTC2->PRESCALER = clocktest::lfPrescaler();
+    NRF_RTC2->EVENTS_TICK = 0;
+    NRF_RTC2->EVTENSET = RTC_EVTEN_TICK_Msk;
+    routeToggle(clocktest::PIN_INDEX, &NRF_RTC2->EVENTS_TICK);
+    NRF_RTC2->TASKS_START = 1;
+    static const char *const SOURCES[] = {"RC", "XTAL", "SYNTH", "?"};
+    Serial.print("Target: CLOCK_UP LF src=");
+    Serial.println(SOURCES[(NRF_CLOCK->LFCLKSTAT & CLOCK_LFCLKSTAT_SRC_Msk) >> CLOCK_LFCLKSTAT_SRC_Pos]);
+  }
+  toggleActive = true;
+}
+
+// HOLD <hex mask>: drive the masked test lines HIGH and the others LOW until
+// the next stage command, so the Master's contact monitor sees a static
+// pattern. Acks "Target: HOLD <mask>"; a malformed mask answers
+// "Target: HOLD_REJECTED <arg>".
+void handleHold(const char *arg) {
+  char *end;
+  uint32_t mask = strtoul(arg, &end, 16);
+  if (end == arg || *end != '\0' || (mask & ~TestPins::all)) {
+    Serial.print("Target: HOLD_REJECTED ");
+    Serial.println(arg);
+    return;
+  }
+  for (int i = 0; i < NUM_TEST_PINS; i++)
+    TestPins::writeAt(i, (mask & (1UL << i)) ? HIGH : LOW);
+  traceEvent('I', "hold", (int)mask);
+  Serial.print("Target: HOLD ");
+  Serial.println(mask, HEX);
+}
+
+// VCC CYCLE: the switch script of vcc_test.h. VccCtrl and the ref line switch
+// in one register write, so the Master measures from the same instant.
+// Blocks for about 100 ms, then acks "Target: VCC_DONE" with all lines LOW;
+// anything else answers "Target: VCC_REJECTED <arg>".
+void handleVcc(const char *arg) {
+  constexpr uint8_t port = VccCtrl::port;
+  constexpr uint32_t ref = TestPins::masks[vcctest::REF_INDEX];
+  static_assert(TestPins::masks[vcctest::VCC_INDEX] == VccCtrl::mask, "VccCtrl is test line VCC_INDEX");
+  static_assert(TestPins::ports[vcctest::REF_INDEX] == port, "ref line on the VccCtrl port");
+  if (strcasecmp(arg, "CYCLE") != 0) {
+    Serial.print("Target: VCC_REJECTED ");
+    Serial.println(arg);
+    return;
+  }
+  traceEvent('B', "vcc_cycle");
+  for (int i = 0; i < NUM_TEST_PINS; i++)
+    TestPins::writeAt(i, i != vcctest::REF_INDEX); // ref stays LOW: no edge yet
+  delay(vcctest::SETTLE_MS);
+  fastgpio::portReg(port)->OUTSET = ref;
+  delay(vcctest::WATCH_MS);
+  fastgpio::portReg(port)->OUTCLR = ref | VccCtrl::mask;
+  delay(vcctest::OFF_MS);
+  fastgpio::portReg(port)->OUTSET = ref | VccCtrl::mask;
+  delay(vcctest::ON_MS);
+  setAll(LOW);
+  traceEvent('E', "vcc_cycle");
+  Serial.println("Target: VCC_DONE");
+}
+
+// Drive the standalone script phase for the time since boot. Phases are
+// applied once, on entry; the Master samples the middle of each slot.
+void standaloneStep(unsigned long now) {
+  const int done = 3 + NUM_TEST_PINS;
+  unsigned long t = now - saStartMs;
+  int phase;
+  if (t < standalone::LEAD_MS) {
+    phase = 0;
+  } else {
+    t -= standalone::LEAD_MS;
+    if (t < standalone::STAGE_MS)
+      phase = 1;
+    else if (t < 2 * standalone::STAGE_MS)
+      phase = 2;
+    else
+      phase = 3 + (int)((t - 2 * standalone::STAGE_MS) / standalone::SEQ_MS);
+  }
+  if (phase > done)
+    phase = done;
+  if (phase == saPhase)
+    return;
+  saPhase = phase;
+
+  if (phase == 1) {
+    setAll(HIGH);
+    LedStatus::high();
+  } else if (phase == 2) {
+    setAll(LOW);
+  } else if (phase > 2) {
+    setAll(LOW); // also drops the previous pin if a slot was skipped
+    if (phase < done) {
+      TestPins::writeAt(phase - 3, HIGH);
+    } else {
+      LedStatus::low();
+      VccCtrl::high(); // beacon again, so the Master can tell a swap from a seated board
+      state = STATE_IDLE; // the Master resets or the operator swaps the Target
+    }
   }
 }
 
@@ -45,57 +527,123 @@ void setup() {
   }
 #endif
 
-  pinMode(LED_STATUS_PIN, OUTPUT);
-  digitalWrite(LED_STATUS_PIN, LOW);
+  LedStatus::mode(fastgpio::Output);
+  LedStatus::low();
+
+  TestPins::write(LOW); // VccCtrl included
+  TestPins::mode(fastgpio::Output);
 
-  pinMode(VCC_CTRL_PIN, OUTPUT);
-  digitalWrite(VCC_CTRL_PIN, LOW);
+  // Presence beacon: powered VCC tells the Master a Target is seated (auto
+  // start). The first test stage takes over the line.
+  VccCtrl::high();
 
-  for (int i = 0; i < NUM_TEST_PINS; i++) {
-    pinMode(TEST_PINS[i], OUTPUT);
-    digitalWrite(TEST_PINS[i], LOW);
+  // No USB host opened the port: play the standalone script
+  if (!Serial) {
+    state = STATE_STANDALONE;
+    saStartMs = millis();
   }
 }
 
 void loop() {
   unsigned long now = millis();
   static int seqIndex = 0;
+  static uint32_t seqMask = TestPins::all; // START_SEQUENCE <hex mask>: pins to pulse
 
-  if (Serial.available()) {
-    String cmd = Serial.readStringUntil('\n');
-    cmd.trim();
+  // A host attached mid-script: stop it and fall back to the handshake
+  if (state == STATE_STANDALONE && Serial) {
+    setAll(LOW);
+    VccCtrl::high();
+    LedStatus::low();
+    state = STATE_HANDSHAKE;
+  }
 
-    if (cmd.equalsIgnoreCase("INIT")) {
+  const char *cmd = readCommand();
+  if (cmd) {
+    // A stage command ends a XTALK/CLOCK output the host did not stop
+    if (toggleActive && (strcasecmp(cmd, "INIT") == 0 || strncasecmp(cmd, "START_", 6) == 0 ||
+                        strcasecmp(cmd, "NEXT_PIN") == 0 || strncasecmp(cmd, "HOLD ", 5) == 0 ||
+                        strncasecmp(cmd, "VCC ", 4) == 0))
+      toggleStop();
+    if (strcasecmp(cmd, "TIMESYNC") == 0) {
+      Serial.print("Target: TIMESYNC ");
+      Serial.println(micros());
+    } else if (strcasecmp(cmd, "TRACE ON") == 0) {
+      traceEnabled = true;
+      Serial.println("Target: TRACE_ON");
+    } else if (strcasecmp(cmd, "TRACE OFF") == 0) {
+      traceEnabled = false;
+      Serial.println("Target: TRACE_OFF");
+    } else if (strcasecmp(cmd, "INIT") == 0) {
       state = STATE_IDLE;
+      VccCtrl::high(); // presence beacon back: the Master's seat detection trusts the lines again
       Serial.println("Target: READY");
-      digitalWrite(LED_STATUS_PIN, LOW);
-    } else if (cmd.equalsIgnoreCase("START_ALL_HIGH")) {
+      LedStatus::low();
+    } else if (strncasecmp(cmd, "START_ALL_HIGH", 14) == 0 && (cmd[14] == ' ' || cmd[14] == '\0')) {
       state = STATE_IDLE; // auto-transition if INIT was missed
       Serial.println("Target: STAGE — ALL_HIGH: BEGIN");
-      setAll(HIGH);
-      digitalWrite(LED_STATUS_PIN, HIGH);
+      traceEvent('I', "set_all_high");
+      // Lines outside the mask stay LOW: an unpopulated pad may be wired to something else
+      uint32_t mask = cmd[14] ? strtoul(cmd + 15, nullptr, 16) & TestPins::all : TestPins::all;
+      for (int i = 0; i < NUM_TEST_PINS; i++)
+        TestPins::writeAt(i, (mask & (1UL << i)) ? HIGH : LOW);
+      LedStatus::high();
       Serial.println("Target: STAGE — ALL_HIGH: OK");
-    } else if (cmd.equalsIgnoreCase("START_ALL_LOW")) {
+    } else if (strncasecmp(cmd, "START_ALL_LOW", 13) == 0 && (cmd[13] == ' ' || cmd[13] == '\0')) {
+      // Every line goes LOW; a mask argument changes nothing
       state = STATE_IDLE;
       Serial.println("Target: STAGE — ALL_LOW: BEGIN");
+      traceEvent('I', "set_all_low");
       setAll(LOW);
-      digitalWrite(LED_STATUS_PIN, LOW);
+      LedStatus::low();
       Serial.println("Target: STAGE — ALL_LOW: OK");
-    } else if (cmd.equalsIgnoreCase("START_SEQUENCE")) {
+    } else if (strncasecmp(cmd, "START_SEQUENCE", 14) == 0 && (cmd[14] == ' ' || cmd[14] == '\0')) {
       state = STATE_IDLE;
       Serial.println("Target: STAGE — SEQUENCE: BEGIN");
+      seqMask = cmd[14] ? strtoul(cmd + 15, nullptr, 16) & TestPins::all : TestPins::all;
       seqIndex = 0;
-    } else if (cmd.equalsIgnoreCase("NEXT_PIN")) {
+      while (seqIndex < NUM_TEST_PINS && !(seqMask & (1UL << seqIndex)))
+        seqIndex++;
+    } else if (strcasecmp(cmd, "NEXT_PIN") == 0) {
       state = STATE_IDLE;
       if (seqIndex < NUM_TEST_PINS) {
-        digitalWrite(TEST_PINS[seqIndex], HIGH);
+        traceEvent('B', "pulse", seqIndex);
+        TestPins::writeAt(seqIndex, HIGH);
+        // Ack for paced hosts: the Master may now check this pin
+        Serial.print("Target: PIN_UP ");
+        Serial.println(seqIndex);
         delay(SEQ_MS);
-        digitalWrite(TEST_PINS[seqIndex], LOW);
-        seqIndex++;
+        TestPins::writeAt(seqIndex, LOW);
+        traceEvent('E', "pulse", seqIndex);
+        do
+          seqIndex++;
+        while (seqIndex < NUM_TEST_PINS && !(seqMask & (1UL << seqIndex)));
         if (seqIndex == NUM_TEST_PINS) {
           Serial.println("Target: STAGE — SEQUENCE: ALL OK");
         }
       }
+    } else if (strcasecmp(cmd, "HELLO?") == 0) {
+      printDescriptor();
+    } else if (strcasecmp(cmd, "ID?") == 0) {
+      printIdentity();
+    } else if (strcasecmp(cmd, "MEM") == 0) {
+      reportMemory();
+    } else if (strncasecmp(cmd, "PING", 4) == 0 &&
+               (cmd[4] == ' ' || cmd[4] == '\0')) {
+      handlePing(cmd + 4);
+    } else if (strncasecmp(cmd, "BLAST ", 6) == 0) {
+      handleBlast(cmd + 6);
+    } else if (strncasecmp(cmd, "XTALK ", 6) == 0) {
+      state = STATE_IDLE;
+      handleXtalk(cmd + 6);
+    } else if (strncasecmp(cmd, "CLOCK ", 6) == 0) {
+      state = STATE_IDLE;
+      handleClock(cmd + 6);
+    } else if (strncasecmp(cmd, "HOLD ", 5) == 0) {
+      state = STATE_IDLE;
+      handleHold(cmd + 5);
+    } else if (strncasecmp(cmd, "VCC ", 4) == 0) {
+      state = STATE_IDLE;
+      handleVcc(cmd + 4);
     }
   }
 
@@ -103,8 +651,10 @@ void loop() {
     if (now - lastBlinkMs >= 200) {
       Serial.println("Hello! I am Target!");
       lastBlinkMs = now;
-      digitalWrite(LED_STATUS_PIN, !digitalRead(LED_STATUS_PIN));
+      LedStatus::toggle();
     }
+  } else if (state == STATE_STANDALONE) {
+    standaloneStep(now);
   } else {
     // Heartbeat
     if (now - lastBlinkMs >= 500) {